@@ -0,0 +1,113 @@
+#include "Benchmark.h"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <new>
+
+static std::atomic<uint64_t> allocationCount(0);
+
+void *operator new(size_t size)
+{
+    ++allocationCount;
+
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+namespace hrm
+{
+
+    void Benchmark::add(const std::string &name, Function function)
+    {
+        benchmarks.push_back(std::make_pair(name, function));
+    }
+
+    void Benchmark::run(const std::string &filter, double minTime)
+    {
+        for (auto &benchmark : benchmarks) {
+            if (benchmark.first.find(filter) == std::string::npos)
+                continue;
+
+            BenchmarkResult result;
+            result.name = benchmark.first;
+
+            // Warm up (plans, window tables, buffers)
+            benchmark.second(1);
+
+            for (uint64_t iterations = 1; ; iterations *= 2) {
+                uint64_t allocationsBefore = allocations();
+                auto start = std::chrono::steady_clock::now();
+
+                uint64_t items = benchmark.second(iterations);
+
+                double seconds = std::chrono::duration<double>(
+                                     std::chrono::steady_clock::now() - start).count();
+                uint64_t allocated = allocations() - allocationsBefore;
+
+                if (seconds < minTime && iterations < (1ULL << 40))
+                    continue;
+
+                result.iterations = iterations;
+                result.seconds = seconds;
+                result.nsPerOp = seconds * 1e9 / iterations;
+                result.itemsPerSecond = items / seconds;
+                result.allocsPerOp = allocated / (double) iterations;
+                break;
+            }
+
+            fprintf(stderr, "%-60s %12.1f ns/op %14.0f items/s %8.3f allocs/op\n",
+                    result.name.c_str(), result.nsPerOp, result.itemsPerSecond,
+                    result.allocsPerOp);
+
+            results.push_back(result);
+        }
+    }
+
+    void Benchmark::list(FILE *file)
+    {
+        for (auto &benchmark : benchmarks)
+            fprintf(file, "%s\n", benchmark.first.c_str());
+    }
+
+    void Benchmark::writeJSON(FILE *file)
+    {
+        fprintf(file, "{\n  \"benchmarks\": [\n");
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult &result = results[i];
+
+            fprintf(file, "    {\"name\": \"%s\", \"iterations\": %llu, \"seconds\": %.6f, "
+                    "\"ns_per_op\": %.3f, \"items_per_s\": %.1f, \"allocs_per_op\": %.4f}%s\n",
+                    result.name.c_str(), (unsigned long long) result.iterations,
+                    result.seconds, result.nsPerOp, result.itemsPerSecond,
+                    result.allocsPerOp, i + 1 < results.size() ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+    }
+
+    uint64_t Benchmark::allocations()
+    {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+}
@@ -0,0 +1,73 @@
+/**
+ * Minimal benchmark harness for hrm_bench.
+ *
+ * Each benchmark is a function that runs a given number of operations
+ * and returns the number of processed items (samples, lines, ...). The
+ * number of operations is doubled until a run takes at least the
+ * minimum time. Heap allocations are counted by replacing the global
+ * operator new (Benchmark.cpp).
+ *
+ * The results are written as JSON, so two builds can be diffed:
+ *
+ *   {"benchmarks": [{"name": ..., "iterations": ..., "ns_per_op": ...,
+ *                    "items_per_s": ..., "allocs_per_op": ...}, ...]}
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#define DEFAULT_MIN_TIME 0.2 // s
+
+namespace hrm
+{
+
+    struct BenchmarkResult {
+        std::string name;
+        uint64_t iterations = 0;
+        double seconds = 0.0;
+        double nsPerOp = 0.0;
+        double itemsPerSecond = 0.0;
+        double allocsPerOp = 0.0;
+    };
+
+    class Benchmark
+    {
+        public:
+            /**
+             * @return Number of processed items.
+             */
+            typedef std::function<uint64_t(uint64_t iterations)> Function;
+
+        private:
+            std::vector<std::pair<std::string, Function>> benchmarks;
+            std::vector<BenchmarkResult> results;
+
+        public:
+            void add(const std::string &name, Function function);
+
+            /**
+             * Runs all benchmarks whose name contains the filter.
+             */
+            void run(const std::string &filter, double minTime = DEFAULT_MIN_TIME);
+
+            void list(FILE *file);
+            void writeJSON(FILE *file);
+
+            /**
+             * Number of heap allocations since program start.
+             */
+            static uint64_t allocations();
+    };
+
+}
+
+#endif
@@ -0,0 +1,543 @@
+/**
+ * Benchmarks of the DSP, parsing and plotting hot paths.
+ *
+ * hrm_bench [--filter <text>] [--json <file>] [--min-time <s>] [--list]
+ *
+ * The results are printed to stderr and written as JSON to the file
+ * (or stdout).
+ *
+ * @author Jens Gansloser
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "BeatDetector.h"
+#include "Benchmark.h"
+#include "FFT.h"
+#include "FFTBuffer.h"
+#include "FFTPlanCache.h"
+#include "LineParser.h"
+#include "Pipeline.h"
+#include "SensorPool.h"
+#include "Statistics.h"
+#include "Trace.h"
+
+#ifdef Qt5
+#include <QApplication>
+#include <QImage>
+#include "MouseMonitorPlot.h"
+#endif
+
+#ifdef _WIN32
+const static double M_PI = 3.14159265359;
+#endif
+
+#define BENCH_SAMPLE_INTERVAL 20.0 // ms
+#define BENCH_HEART_RATE 72.0 // bpm
+#define BENCH_SENSOR_CHUNK 50 // Lines per feed (one serial read)
+#define BENCH_SENSOR_BATCH 64 // Chunks per sensor in flight
+
+using namespace hrm;
+
+// Keeps the compiler from removing the benchmarked work.
+static volatile double sink;
+
+/**
+ * Deterministic synthetic PPG: pulse with harmonics, breathing
+ * baseline and noise (LCG), in sensor units.
+ */
+class SyntheticPPG
+{
+    private:
+        double t = 0.0;
+        uint32_t state = 12345;
+
+    public:
+        double next() {
+            double f = BENCH_HEART_RATE / 60.0;
+            double phase = 2 * M_PI * f * t;
+
+            double pulse = sin(phase) + 0.5 * sin(2 * phase + 0.4) + 0.2 * sin(3 * phase + 1.1);
+            double breathing = 0.8 * sin(2 * M_PI * 0.25 * t);
+
+            state = state * 1664525u + 1013904223u;
+            double noise = (state >> 8) / (double)(1 << 24) - 0.5;
+
+            t += BENCH_SAMPLE_INTERVAL / 1000.0;
+            return 20000.0 + 400.0 * pulse + 300.0 * breathing + 50.0 * noise;
+        }
+
+        SensorData nextData() {
+            SensorData data;
+            data.broadband = (uint16_t) next();
+            data.ir = data.broadband / 2;
+            return data;
+        }
+};
+
+static std::vector<double> makeSignal(size_t size)
+{
+    SyntheticPPG ppg;
+    std::vector<double> signal(size);
+    for (size_t i = 0; i < size; ++i)
+        signal[i] = ppg.next();
+    return signal;
+}
+
+/**
+ * Mostly data lines, some settings lines and malformed lines, as
+ * received from the sensor.
+ */
+static std::string makeLines(int count)
+{
+    SyntheticPPG ppg;
+    std::string lines;
+    char line[128];
+
+    for (int i = 0; i < count; ++i) {
+        if (i % 500 == 0) {
+            snprintf(line, sizeof(line), "settings: sensor TSL2561 id 1 max 65535 min 0 "
+                     "resolution 1 sampleInterval 20\r\n");
+        } else if (i % 97 == 0) {
+            snprintf(line, sizeof(line), "data: broadband ir 12\r\n");
+        } else {
+            SensorData data = ppg.nextData();
+            snprintf(line, sizeof(line), "data: broadband %u ir %u\r\n",
+                     data.broadband, data.ir);
+        }
+        lines += line;
+    }
+
+    return lines;
+}
+
+static const char *windowName(int window)
+{
+    static const char *names[] = {"hamming", "hann", "blackman", "blackman_harris",
+                                  "kaiser", "flat_top"
+                                 };
+    return window < 0 ? "none" : names[window];
+}
+
+static void addBufferBenchmarks(Benchmark &benchmark, const std::vector<double> &signal)
+{
+    int effectiveSizes[] = {128, 256, 512};
+    int windowSizes[] = {1, 5, 32};
+
+    for (int effective : effectiveSizes) {
+        for (int window : windowSizes) {
+            std::string name = "fftbuffer_add/effective=" + std::to_string(effective) +
+                               "/window=" + std::to_string(window);
+
+            benchmark.add(name, [&signal, effective, window](uint64_t iterations) {
+                FFTBuffer buffer(effective, DEFAULT_TOTAL_SAMPLES - effective, window);
+                uint64_t full = 0;
+
+                for (uint64_t i = 0; i < iterations; ++i)
+                    full += buffer.add(signal[i % signal.size()]);
+
+                sink = full;
+                return iterations;
+            });
+        }
+    }
+}
+
+static void addFFTBenchmarks(Benchmark &benchmark, const std::vector<double> &signal)
+{
+    for (int window = -1; window <= FLAT_TOP; ++window) {
+        for (int filter = 0; filter <= 1; ++filter) {
+            for (int scaling = 0; scaling <= 1; ++scaling) {
+                std::string name = std::string("fft_add_sample/window=") + windowName(window) +
+                                   "/filter=" + std::to_string(filter) +
+                                   "/scaling=" + std::to_string(scaling);
+
+                benchmark.add(name, [&signal, window, filter, scaling](uint64_t iterations) {
+                    FFT fft(BENCH_SAMPLE_INTERVAL);
+                    fft.setUseWindowFunction(window >= 0);
+                    if (window >= 0)
+                        fft.setWindowType((WINDOW_TYPE) window);
+                    fft.setUseFilter(filter);
+                    fft.setUseScaling(scaling);
+
+                    for (uint64_t i = 0; i < iterations; ++i)
+                        fft.addSample(signal[i % signal.size()]);
+
+                    return iterations;
+                });
+            }
+        }
+    }
+
+    // One operation = one inverse transform and lag search of a frame
+    benchmark.add("fft_autocorrelation_peak", [&signal](uint64_t iterations) {
+        FFT fft(BENCH_SAMPLE_INTERVAL);
+        fft.setUseAutocorrelation(true);
+
+        size_t i = 0;
+        while (!fft.addSample(signal[i++ % signal.size()]));
+
+        double frequency = 0.0;
+        for (uint64_t j = 0; j < iterations; ++j)
+            frequency += fft.getAutocorrelationPeak().frequency;
+
+        sink = frequency;
+        return iterations;
+    });
+}
+
+static void addParserBenchmarks(Benchmark &benchmark, const std::string &lines)
+{
+    // Serial passes what one readyRead() delivered.
+    int chunkSizes[] = {64, 4096};
+
+    for (int chunk : chunkSizes) {
+        std::string name = "line_parser/mixed/chunk=" + std::to_string(chunk);
+
+        benchmark.add(name, [&lines, chunk](uint64_t iterations) {
+            LineParser parser;
+            uint64_t samples = 0;
+            parser.setDataCallback([&samples](const SensorData &) {
+                ++samples;
+            });
+
+            std::string buffer;
+            buffer.reserve(2 * chunk + LINE_MAX_LENGTH);
+            size_t position = 0;
+
+            // One operation = one chunk
+            for (uint64_t i = 0; i < iterations; ++i) {
+                size_t size = std::min<size_t>(chunk, lines.size() - position);
+                buffer.append(lines, position, size);
+                position = (position + size) % lines.size();
+
+                size_t consumed = parser.parse(buffer.data(), buffer.size());
+                buffer.erase(0, consumed);
+            }
+
+            return samples;
+        });
+    }
+}
+
+static void addPipelineBenchmarks(Benchmark &benchmark)
+{
+    SPECTRUM_ENGINE engines[] = {ENGINE_FFTW, ENGINE_SLIDING_DFT, ENGINE_CHIRP_Z};
+    const char *names[] = {"fftw", "sliding_dft", "chirp_z"};
+
+    for (int e = 0; e < 3; ++e) {
+        SPECTRUM_ENGINE engine = engines[e];
+        std::string name = std::string("pipeline/ppg_to_bpm/engine=") + names[e];
+
+        benchmark.add(name, [engine](uint64_t iterations) {
+            Pipeline pipeline(BENCH_SAMPLE_INTERVAL);
+            pipeline.getFFT().setEngine(engine);
+
+            double bpm = 0.0;
+            pipeline.setBpmCallback([&bpm](double value, const Peak &) {
+                bpm = value;
+            });
+
+            SyntheticPPG ppg;
+            for (uint64_t i = 0; i < iterations; ++i)
+                pipeline.push(ppg.nextData());
+
+            sink = bpm;
+            return iterations;
+        });
+    }
+
+    benchmark.add("pipeline/ppg_to_bpm/autocorrelation=1", [](uint64_t iterations) {
+        Pipeline pipeline(BENCH_SAMPLE_INTERVAL);
+        pipeline.getFFT().setUseAutocorrelation(true);
+
+        double bpm = 0.0;
+        pipeline.setSpectrumCallback([&bpm](FFT & fft, const Peak &) {
+            bpm = fft.getAutocorrelationPeak().frequency * 60;
+        });
+
+        SyntheticPPG ppg;
+        for (uint64_t i = 0; i < iterations; ++i)
+            pipeline.push(ppg.nextData());
+
+        sink = bpm;
+        return iterations;
+    });
+
+    // Broadband and IR in one batched transform per hop
+    benchmark.add("pipeline/ppg_to_bpm/channels=2", [](uint64_t iterations) {
+        Pipeline pipeline(BENCH_SAMPLE_INTERVAL);
+        pipeline.getFFT().setChannels(SENSOR_CHANNELS);
+
+        double bpm = 0.0;
+        pipeline.setBpmCallback([&bpm](double value, const Peak &) {
+            bpm = value;
+        });
+
+        SyntheticPPG ppg;
+        for (uint64_t i = 0; i < iterations; ++i)
+            pipeline.push(ppg.nextData());
+
+        sink = bpm;
+        return iterations;
+    });
+}
+
+static void addBeatDetectorBenchmarks(Benchmark &benchmark, const std::vector<double> &signal)
+{
+    benchmark.add("beat_detector/add_sample", [&signal](uint64_t iterations) {
+        BeatDetector detector(BENCH_SAMPLE_INTERVAL, DEFAULT_MIN_FREQUENCY, DEFAULT_MAX_FREQUENCY);
+        uint64_t beats = 0;
+
+        for (uint64_t i = 0; i < iterations; ++i)
+            beats += detector.addSample(signal[i % signal.size()]);
+
+        sink = beats;
+        return iterations;
+    });
+
+    // FFT and beat detector side by side
+    benchmark.add("pipeline/ppg_to_bpm/beat_detector=1", [](uint64_t iterations) {
+        Pipeline pipeline(BENCH_SAMPLE_INTERVAL);
+        pipeline.setUseBeatDetector(true);
+
+        double bpm = 0.0;
+        pipeline.setBeatCallback([&bpm](const Beat & beat) {
+            bpm = beat.averageBpm;
+        });
+
+        SyntheticPPG ppg;
+        for (uint64_t i = 0; i < iterations; ++i)
+            pipeline.push(ppg.nextData());
+
+        sink = bpm;
+        return iterations;
+    });
+}
+
+/**
+ * One operation is one sample of every sensor. The lines are fed in
+ * chunks, as read from the serial ports, and processed on the pool
+ * (one worker per core).
+ */
+static void addSensorPoolBenchmarks(Benchmark &benchmark)
+{
+    std::vector<std::string> chunks;
+    SyntheticPPG ppg;
+    char line[128];
+
+    for (int c = 0; c < 60; ++c) {
+        std::string chunk;
+        for (int i = 0; i < BENCH_SENSOR_CHUNK; ++i) {
+            SensorData data = ppg.nextData();
+            snprintf(line, sizeof(line), "data: broadband %u ir %u\r\n",
+                     data.broadband, data.ir);
+            chunk += line;
+        }
+        chunks.push_back(chunk);
+    }
+
+    int counts[] = {1, 8, 64};
+
+    for (int sensors : counts) {
+        std::string name = "sensor_pool/sensors=" + std::to_string(sensors);
+
+        benchmark.add(name, [sensors, chunks](uint64_t iterations) {
+            SensorPool pool;
+            std::vector<int> ids;
+            std::string settings = "settings: sensor TSL2561 id 1 max 65535 min 0 "
+                                   "resolution 1 sampleInterval 20\r\n";
+
+            for (int i = 0; i < sensors; ++i) {
+                ids.push_back(pool.addSensor("bench"));
+                pool.feed(ids.back(), settings.data(), settings.size());
+            }
+
+            uint64_t count = (iterations + BENCH_SENSOR_CHUNK - 1) / BENCH_SENSOR_CHUNK;
+            for (uint64_t c = 0; c < count; ++c) {
+                const std::string &chunk = chunks[c % chunks.size()];
+                for (int id : ids)
+                    pool.feed(id, chunk.data(), chunk.size());
+
+                // Stay below SENSOR_POOL_MAX_INPUT, nothing is dropped.
+                if (c % BENCH_SENSOR_BATCH == BENCH_SENSOR_BATCH - 1)
+                    pool.wait();
+            }
+
+            pool.wait();
+            sink = pool.getSummary().meanBpm;
+
+            return count * BENCH_SENSOR_CHUNK * sensors;
+        });
+    }
+}
+
+static void addStatisticsBenchmarks(Benchmark &benchmark)
+{
+    // Cost of one instrumented stage (two timestamps, one record)
+    benchmark.add("statistics/record", [](uint64_t iterations) {
+        Statistics statistics;
+
+        for (uint64_t i = 0; i < iterations; ++i) {
+            uint64_t begin = Statistics::now();
+            statistics.record(STAGE_FFT, begin, Statistics::now());
+        }
+
+        sink = statistics.getHistogram(STAGE_FFT).getPercentile(99);
+        return iterations;
+    });
+}
+
+static void addTraceBenchmarks(Benchmark &benchmark)
+{
+    benchmark.add("trace/span/disabled", [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) {
+            TRACE_SCOPE("bench");
+            sink = i;
+        }
+        return iterations;
+    });
+
+    benchmark.add("trace/span/enabled", [](uint64_t iterations) {
+        Trace::instance().start();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            TRACE_SCOPE("bench");
+            sink = i;
+        }
+        Trace::instance().stop();
+        return iterations;
+    });
+}
+
+#ifdef Qt5
+static void addPlotBenchmarks(Benchmark &benchmark, const std::vector<double> &signal)
+{
+    benchmark.add("plot/update_plot/limited", [&signal](uint64_t iterations) {
+        minotaur::MouseMonitorPlot plot;
+        plot.init(Qt::blue, "Bench", "x", "y", "curve", minotaur::LIMITED);
+        plot.resize(800, 300);
+
+        QVector<double> value(1);
+        for (uint64_t i = 0; i < iterations; ++i) {
+            value[0] = signal[i % signal.size()];
+            plot.updatePlot(value);
+        }
+
+        // The timer redraws later (not measured here).
+        return iterations;
+    });
+
+    benchmark.add("plot/replot/limited_300", [&signal](uint64_t iterations) {
+        minotaur::MouseMonitorPlot plot;
+        plot.init(Qt::blue, "Bench", "x", "y", "curve", minotaur::LIMITED);
+        plot.resize(800, 300);
+
+        QVector<double> value(1);
+        for (int i = 0; i < 300; ++i) {
+            value[0] = signal[i];
+            plot.updatePlot(value);
+        }
+
+        QImage image(800, 300, QImage::Format_RGB32);
+        for (uint64_t i = 0; i < iterations; ++i) {
+            plot.replot();
+            plot.render(&image);
+        }
+
+        return iterations;
+    });
+
+    benchmark.add("plot/set_series/spectrum_512", [&signal](uint64_t iterations) {
+        minotaur::MouseMonitorPlot plot;
+        plot.init(Qt::blue, "Bench", "x", "y", "curve", minotaur::NO_LIMIT);
+        plot.addCurve("second", Qt::red);
+
+        for (uint64_t i = 0; i < iterations; ++i)
+            plot.setSeries(0.0, 0.05, {signal.data(), signal.data() + 512}, 512);
+
+        return iterations * 512;
+    });
+}
+#endif
+
+static void usage()
+{
+    fprintf(stderr, "hrm_bench [--filter <text>] [--json <file>] [--min-time <s>] [--list]\n");
+}
+
+int main(int argc, char **argv)
+{
+    std::string filter;
+    const char *jsonFile = nullptr;
+    double minTime = DEFAULT_MIN_TIME;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "--json") && i + 1 < argc)
+            jsonFile = argv[++i];
+        else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+            minTime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--list"))
+            list = true;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    // Same plans in every run: No wisdom is loaded and without the
+    // background planner, only the estimated plans are used.
+    FFTPlanCache::instance().stop();
+
+#ifdef Qt5
+    // Render without a display.
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+#endif
+
+    std::vector<double> signal = makeSignal(1 << 16);
+    std::string lines = makeLines(10000);
+
+    Benchmark benchmark;
+    addBufferBenchmarks(benchmark, signal);
+    addFFTBenchmarks(benchmark, signal);
+    addParserBenchmarks(benchmark, lines);
+    addPipelineBenchmarks(benchmark);
+    addBeatDetectorBenchmarks(benchmark, signal);
+    addSensorPoolBenchmarks(benchmark);
+    addStatisticsBenchmarks(benchmark);
+    addTraceBenchmarks(benchmark);
+#ifdef Qt5
+    addPlotBenchmarks(benchmark, signal);
+#endif
+
+    if (list) {
+        benchmark.list(stdout);
+        return 0;
+    }
+
+    benchmark.run(filter, minTime);
+
+    FILE *file = jsonFile ? fopen(jsonFile, "w") : stdout;
+    if (!file) {
+        fprintf(stderr, "Could not open %s\n", jsonFile);
+        return 1;
+    }
+
+    benchmark.writeJSON(file);
+
+    if (file != stdout)
+        fclose(file);
+
+    FFTPlanCache::instance().stop();
+    return 0;
+}
@@ -0,0 +1,393 @@
+/**
+ * Virtual light sensor on a pseudo terminal, a local stand-in for the
+ * hardware in soak and throughput tests.
+ *
+ * hrm_simsensor [--sensors <n>] [--link <path>] [--interval <ms>]
+ *               [--speed <factor>] [--heart-rate <bpm>] [--spread <bpm>]
+ *               [--noise <value>] [--motion <per min>] [--drift <per min>]
+ *               [--seed <n>] [--verbose]
+ *
+ * The device path of every sensor is printed to stdout, one per line.
+ * Open it instead of the serial port (or create symbolic links with
+ * --link). The simulator speaks the text protocol (SensorProtocol.h):
+ *
+ *   get settings             => settings: sensor ... sampleInterval <ms>
+ *   set sampleInterval <ms>
+ *   set protocol binary      => data frames (FrameParser.h)
+ *   set protocol ascii       => data: broadband <n> ir <n>
+ *
+ * --speed multiplies the line rate, the samples (and the reported
+ * sample interval) stay the same, so the BPM seen by the application
+ * does not change. --speed 0 sends as fast as the reader takes them.
+ * Sensor i has the heart rate + i * spread. If a reader falls behind,
+ * the samples that do not fit into its output buffer are skipped, like
+ * the lost bytes of a real serial port.
+ *
+ * @author Jens Gansloser
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameParser.h"
+#include "PPGGenerator.h"
+#include "SensorProtocol.h"
+
+#define SIM_TICK 1 // ms
+#define SIM_MAX_OUTPUT (64 * 1024) // Pending bytes per sensor
+#define SIM_MAX_INPUT 1024 // Longest command line
+#define SIM_FAST_BATCH 256 // Samples per sensor and tick (--speed 0)
+#define SIM_DEFAULT_INTERVAL 20.0 // ms
+
+using namespace hrm;
+
+static volatile sig_atomic_t stopped = 0;
+
+static void stop(int)
+{
+    stopped = 1;
+}
+
+struct SimSensor {
+    int id = 0;
+    int master = -1;
+    // Kept open, so the master does not fail while no reader is
+    // connected.
+    int slave = -1;
+    std::string path;
+    std::string link;
+
+    PPGGenerator generator;
+    double interval = SIM_DEFAULT_INTERVAL; // ms
+    bool binary = false;
+    uint16_t sequence = 0;
+
+    std::string input;
+    std::string output;
+
+    // Time (s) and samples of the last interval change
+    double changeTime = 0.0;
+    uint64_t changeSamples = 0;
+
+    uint64_t samples = 0;
+    uint64_t skipped = 0;
+
+    SimSensor(const PPGSettings &settings) : generator(settings) {}
+};
+
+static double now()
+{
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool openPty(SimSensor &sensor)
+{
+    sensor.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (sensor.master < 0 || grantpt(sensor.master) != 0 || unlockpt(sensor.master) != 0)
+        return false;
+
+    const char *path = ptsname(sensor.master);
+    if (!path)
+        return false;
+    sensor.path = path;
+
+    sensor.slave = open(path, O_RDWR | O_NOCTTY);
+    if (sensor.slave < 0)
+        return false;
+
+    // No echo of the commands, no line translation.
+    struct termios attributes;
+    if (tcgetattr(sensor.slave, &attributes) == 0) {
+        cfmakeraw(&attributes);
+        tcsetattr(sensor.slave, TCSANOW, &attributes);
+    }
+
+    fcntl(sensor.master, F_SETFL, fcntl(sensor.master, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+static void closePty(SimSensor &sensor)
+{
+    if (!sensor.link.empty())
+        unlink(sensor.link.c_str());
+    if (sensor.slave >= 0)
+        close(sensor.slave);
+    if (sensor.master >= 0)
+        close(sensor.master);
+}
+
+static void sendSettings(SimSensor &sensor)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "settings: sensor TSL2561 id %d max 65535 min 0 "
+             "resolution 1 sampleInterval %g\r\n", sensor.id, sensor.interval);
+    sensor.output += line;
+}
+
+static void handleCommand(SimSensor &sensor, std::string command, bool verbose)
+{
+    while (!command.empty() && (command.back() == '\r' || command.back() == ' '))
+        command.pop_back();
+
+    const std::string &setInterval = SensorProtocol::SET_SAMPLE_INTERVAL;
+
+    if (command == SensorProtocol::GET_SETTINGS) {
+        sendSettings(sensor);
+    } else if (command.compare(0, setInterval.size(), setInterval) == 0) {
+        double interval = atof(command.c_str() + setInterval.size());
+        if (interval > 0.0) {
+            // The new rate applies from now on.
+            sensor.changeTime = now();
+            sensor.changeSamples = sensor.samples + sensor.skipped;
+            sensor.interval = interval;
+        }
+    } else if (command == SensorProtocol::SET_PROTOCOL_BINARY) {
+        sensor.binary = true;
+    } else if (command == SensorProtocol::SET_PROTOCOL_ASCII) {
+        sensor.binary = false;
+    } else if (verbose && !command.empty()) {
+        fprintf(stderr, "%s: unknown command \"%s\"\n", sensor.path.c_str(), command.c_str());
+    }
+}
+
+static void receiveCommands(SimSensor &sensor, bool verbose)
+{
+    char buffer[256];
+    ssize_t size;
+
+    while ((size = read(sensor.master, buffer, sizeof(buffer))) > 0)
+        sensor.input.append(buffer, size);
+
+    size_t start = 0;
+    size_t end;
+    while ((end = sensor.input.find('\n', start)) != std::string::npos) {
+        handleCommand(sensor, sensor.input.substr(start, end - start), verbose);
+        start = end + 1;
+    }
+    sensor.input.erase(0, start);
+
+    if (sensor.input.size() > SIM_MAX_INPUT)
+        sensor.input.clear();
+}
+
+/**
+ * Appends the samples due until now to the output buffer.
+ */
+static void generate(SimSensor &sensor, double time, double speed)
+{
+    uint64_t count;
+
+    if (speed > 0.0) {
+        uint64_t due = sensor.changeSamples +
+                       (uint64_t)((time - sensor.changeTime) * speed * 1000.0 / sensor.interval);
+        count = due - std::min(due, sensor.samples + sensor.skipped);
+    } else {
+        count = SIM_FAST_BATCH;
+    }
+
+    SensorData frame[FRAME_MAX_SAMPLES];
+    int frameSize = 0;
+    uint8_t encoded[FRAME_HEADER_SIZE + 2 + 4 * FRAME_MAX_SAMPLES + FRAME_CRC_SIZE];
+    char line[64];
+
+    for (uint64_t i = 0; i < count; ++i) {
+        if (sensor.output.size() >= SIM_MAX_OUTPUT && speed == 0.0)
+            break;
+
+        SensorData data = sensor.generator.next(sensor.interval);
+
+        if (sensor.output.size() >= SIM_MAX_OUTPUT) {
+            ++sensor.skipped;
+            continue;
+        }
+
+        ++sensor.samples;
+
+        if (!sensor.binary) {
+            int length = snprintf(line, sizeof(line), "data: broadband %u ir %u\r\n",
+                                  data.broadband, data.ir);
+            sensor.output.append(line, length);
+            continue;
+        }
+
+        frame[frameSize++] = data;
+        if (frameSize == FRAME_MAX_SAMPLES) {
+            size_t size = FrameParser::encode(frame, frameSize, sensor.sequence++, encoded);
+            sensor.output.append((const char *) encoded, size);
+            frameSize = 0;
+        }
+    }
+
+    if (frameSize > 0) {
+        size_t size = FrameParser::encode(frame, frameSize, sensor.sequence++, encoded);
+        sensor.output.append((const char *) encoded, size);
+    }
+}
+
+static void send(SimSensor &sensor)
+{
+    if (sensor.output.empty())
+        return;
+
+    ssize_t written = write(sensor.master, sensor.output.data(), sensor.output.size());
+    if (written > 0)
+        sensor.output.erase(0, written);
+}
+
+static void usage()
+{
+    fprintf(stderr, "hrm_simsensor [--sensors <n>] [--link <path>] [--interval <ms>]\n"
+            "              [--speed <factor>] [--heart-rate <bpm>] [--spread <bpm>]\n"
+            "              [--noise <value>] [--motion <per min>] [--drift <per min>]\n"
+            "              [--seed <n>] [--verbose]\n");
+}
+
+int main(int argc, char **argv)
+{
+    PPGSettings settings;
+    int count = 1;
+    const char *link = nullptr;
+    double interval = SIM_DEFAULT_INTERVAL;
+    double speed = 1.0;
+    double spread = 0.0;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--sensors") && i + 1 < argc)
+            count = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--link") && i + 1 < argc)
+            link = argv[++i];
+        else if (!strcmp(argv[i], "--interval") && i + 1 < argc)
+            interval = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--speed") && i + 1 < argc)
+            speed = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--heart-rate") && i + 1 < argc)
+            settings.heartRate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--spread") && i + 1 < argc)
+            spread = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--noise") && i + 1 < argc)
+            settings.noise = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--motion") && i + 1 < argc)
+            settings.motionRate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--drift") && i + 1 < argc)
+            settings.drift = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            settings.seed = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--verbose"))
+            verbose = true;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (count < 1 || interval <= 0.0 || speed < 0.0) {
+        usage();
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<std::unique_ptr<SimSensor>> sensors;
+
+    for (int i = 0; i < count; ++i) {
+        PPGSettings sensorSettings = settings;
+        sensorSettings.heartRate += i * spread;
+        sensorSettings.seed += i;
+
+        std::unique_ptr<SimSensor> sensor(new SimSensor(sensorSettings));
+        sensor->id = i + 1;
+        sensor->interval = interval;
+
+        if (!openPty(*sensor)) {
+            fprintf(stderr, "Could not create a pseudo terminal: %s\n", strerror(errno));
+            closePty(*sensor);
+            for (auto &s : sensors)
+                closePty(*s);
+            return 1;
+        }
+
+        if (link) {
+            sensor->link = count > 1 ? link + std::to_string(i) : link;
+            unlink(sensor->link.c_str());
+            if (symlink(sensor->path.c_str(), sensor->link.c_str()) != 0) {
+                fprintf(stderr, "Could not create %s: %s\n", sensor->link.c_str(), strerror(errno));
+                sensor->link.clear();
+            }
+        }
+
+        printf("%s\n", sensor->link.empty() ? sensor->path.c_str() : sensor->link.c_str());
+        sensors.push_back(std::move(sensor));
+    }
+    fflush(stdout);
+
+    std::vector<struct pollfd> fds(count);
+    double start = now();
+    double lastReport = start;
+
+    for (auto &sensor : sensors)
+        sensor->changeTime = start;
+    uint64_t lastSamples = 0;
+
+    while (!stopped) {
+        double time = now();
+
+        for (int i = 0; i < count; ++i) {
+            SimSensor &sensor = *sensors[i];
+
+            generate(sensor, time, speed);
+            send(sensor);
+
+            fds[i].fd = sensor.master;
+            fds[i].events = POLLIN;
+            if (speed == 0.0 && !sensor.output.empty())
+                fds[i].events |= POLLOUT;
+            fds[i].revents = 0;
+        }
+
+        if (poll(fds.data(), count, SIM_TICK) < 0 && errno != EINTR)
+            break;
+
+        for (int i = 0; i < count; ++i) {
+            if (fds[i].revents & POLLIN)
+                receiveCommands(*sensors[i], verbose);
+        }
+
+        if (verbose && time - lastReport >= 1.0) {
+            uint64_t samples = 0;
+            uint64_t skipped = 0;
+            for (auto &sensor : sensors) {
+                samples += sensor->samples;
+                skipped += sensor->skipped;
+            }
+
+            fprintf(stderr, "%.0f samples/s, %llu samples, %llu skipped\n",
+                    (samples - lastSamples) / (time - lastReport),
+                    (unsigned long long) samples, (unsigned long long) skipped);
+
+            lastSamples = samples;
+            lastReport = time;
+        }
+    }
+
+    for (auto &sensor : sensors)
+        closePty(*sensor);
+
+    return 0;
+}
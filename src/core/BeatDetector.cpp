@@ -0,0 +1,219 @@
+#include "BeatDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+const static double M_PI = 3.14159265359;
+#endif
+
+namespace hrm
+{
+
+    BeatDetector::BeatDetector(double sampleInterval, double minFrequency, double maxFrequency) :
+        sampleInterval(sampleInterval),
+        minFrequency(minFrequency),
+        maxFrequency(maxFrequency)
+    {
+        reset();
+    }
+
+    /**
+     * Butterworth (Q = 1/sqrt(2)) biquads of the audio EQ cookbook. The
+     * low-pass stays below the Nyquist frequency.
+     */
+    void BeatDetector::updateCoefficients()
+    {
+        double sampleRate = 1000.0 / sampleInterval;
+        double q = 1.0 / sqrt(2.0);
+
+        // Below the band, the fundamental of slow pulses is not
+        // attenuated against its harmonics.
+        double w = 2 * M_PI * BEAT_HIGH_PASS * minFrequency / sampleRate;
+        double alpha = sin(w) / (2 * q);
+        double a0 = 1 + alpha;
+
+        highPass.b0 = (1 + cos(w)) / 2 / a0;
+        highPass.b1 = -(1 + cos(w)) / a0;
+        highPass.b2 = highPass.b0;
+        highPass.a1 = -2 * cos(w) / a0;
+        highPass.a2 = (1 - alpha) / a0;
+
+        w = 2 * M_PI * std::min(maxFrequency, 0.45 * sampleRate) / sampleRate;
+        alpha = sin(w) / (2 * q);
+        a0 = 1 + alpha;
+
+        lowPass.b0 = (1 - cos(w)) / 2 / a0;
+        lowPass.b1 = (1 - cos(w)) / a0;
+        lowPass.b2 = lowPass.b0;
+        lowPass.a1 = -2 * cos(w) / a0;
+        lowPass.a2 = (1 - alpha) / a0;
+
+        double dt = sampleInterval / 1000.0;
+        window.assign(std::max(1, (int) round(BEAT_WINDOW / dt)), 0.0);
+
+        levelDecay = pow(0.5, dt / BEAT_LEVEL_HALF_LIFE);
+        envelopeDecay = pow(0.5, dt / BEAT_ENVELOPE_HALF_LIFE);
+    }
+
+    void BeatDetector::reset()
+    {
+        updateCoefficients();
+
+        highPass.z1 = highPass.z2 = 0.0;
+        lowPass.z1 = lowPass.z2 = 0.0;
+        previous = 0.0;
+
+        windowPos = 0;
+        riseSum = 0.0;
+        fallSum = 0.0;
+
+        sample = 0;
+        time = 0.0;
+
+        riseEnvelope = 0.0;
+        fallEnvelope = 0.0;
+        rising = true;
+        level = 0.0;
+
+        inEdge = false;
+        hasBeat = false;
+        lastBeat = Beat();
+
+        intervalPos = 0;
+        intervalCount = 0;
+        intervalSum = 0.0;
+    }
+
+    bool BeatDetector::addSample(double value)
+    {
+        if (sample == 0) {
+            // Steady state for the DC level, no start transient.
+            highPass.z1 = -highPass.b0 * value;
+            highPass.z2 = highPass.b2 * value;
+        }
+
+        double filtered = lowPass.process(highPass.process(value));
+        double slope = sample == 0 ? 0.0 : filtered - previous;
+        previous = filtered;
+
+        double &oldest = window[windowPos];
+        riseSum += std::max(slope, 0.0) - std::max(oldest, 0.0);
+        fallSum += std::max(-slope, 0.0) - std::max(-oldest, 0.0);
+        oldest = slope;
+        windowPos = (windowPos + 1) % window.size();
+
+        riseEnvelope = std::max(riseSum, riseEnvelope * envelopeDecay);
+        fallEnvelope = std::max(fallSum, fallEnvelope * envelopeDecay);
+
+        bool detected = false;
+
+        if (time < BEAT_LEARNING_TIME) {
+            // Initial level: steepest edge so far
+            level = std::max(riseEnvelope, fallEnvelope);
+        } else {
+            detected = detect();
+        }
+
+        ++sample;
+        time += sampleInterval / 1000.0;
+
+        return detected;
+    }
+
+    bool BeatDetector::detect()
+    {
+        if (!inEdge)
+            rising = riseEnvelope >= fallEnvelope;
+
+        double value = rising ? riseSum : fallSum;
+        double threshold = BEAT_THRESHOLD * level;
+
+        bool refractory = hasBeat && time - lastBeatTime < 1.0 / maxFrequency;
+
+        if (value > threshold && !refractory) {
+            if (!inEdge || value > edgeMaximum) {
+                edgeMaximum = value;
+                edgeSample = sample;
+                edgeTime = time;
+            }
+            inEdge = true;
+            return false;
+        }
+
+        if (!inEdge) {
+            // Lost the rhythm (weaker signal), lower the threshold.
+            if (!hasBeat || time - lastBeatTime > 1.0 / minFrequency)
+                level *= levelDecay;
+            return false;
+        }
+
+        // Edge is over: beat at its steepest point
+        inEdge = false;
+
+        // Artifacts raise the level only slowly, so a stronger signal
+        // is still followed.
+        bool artifact = edgeMaximum > BEAT_ARTIFACT * level;
+        level = (1 - BEAT_LEVEL_WEIGHT) * level +
+                BEAT_LEVEL_WEIGHT * std::min(edgeMaximum, BEAT_ARTIFACT * level);
+
+        if (artifact)
+            return false;
+
+        Beat beat;
+        beat.sample = edgeSample;
+        beat.time = edgeTime;
+        beat.latency = time - edgeTime;
+
+        if (hasBeat) {
+            double interval = edgeTime - lastBeatTime;
+
+            if (interval >= 1.0 / maxFrequency && interval <= 1.0 / minFrequency) {
+                beat.interval = interval;
+                beat.bpm = 60.0 / interval;
+
+                if (intervalCount == BEAT_AVERAGE)
+                    intervalSum -= intervals[intervalPos];
+                else
+                    ++intervalCount;
+
+                intervals[intervalPos] = interval;
+                intervalSum += interval;
+                intervalPos = (intervalPos + 1) % BEAT_AVERAGE;
+            }
+        }
+
+        if (intervalCount > 0)
+            beat.averageBpm = 60.0 / (intervalSum / intervalCount);
+
+        hasBeat = true;
+        lastBeatTime = edgeTime;
+        lastBeat = beat;
+
+        return true;
+    }
+
+    void BeatDetector::setSampleInterval(double sampleInterval)
+    {
+        this->sampleInterval = sampleInterval;
+        reset();
+    }
+
+    void BeatDetector::setBand(double minFrequency, double maxFrequency)
+    {
+        this->minFrequency = minFrequency;
+        this->maxFrequency = maxFrequency;
+        reset();
+    }
+
+    const Beat &BeatDetector::getLastBeat()
+    {
+        return lastBeat;
+    }
+
+    double BeatDetector::getBpm()
+    {
+        return lastBeat.averageBpm;
+    }
+
+}
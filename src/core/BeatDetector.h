@@ -0,0 +1,161 @@
+/**
+ * Streaming beat detector in the time domain, a low-cost estimator next
+ * to the FFT.
+ *
+ * Every sample passes:
+ *
+ *   band-pass (2nd order high-pass below minFrequency, 2nd order
+ *   low-pass at maxFrequency) -> derivative -> moving window integration of the
+ *   rise (or fall) -> adaptive threshold peak detection
+ *
+ * A beat is the steepest edge of a pulse. The integration over
+ * BEAT_WINDOW sums the slope of the whole edge, so the harmonics of the
+ * pulse do not give several peaks per beat. The polarity of the edge is
+ * chosen automatically (the steeper one of rise and fall), so inverted
+ * signals work too. Edges much steeper than the beats before (motion
+ * artifacts) are ignored. The threshold is BEAT_THRESHOLD of the running
+ * level of the detected beats and decays while no beat is found. After
+ * a beat, no other beat is accepted for 1 / maxFrequency s.
+ *
+ * The cost is O(1) per sample. The first beat is reported after
+ * BEAT_LEARNING_TIME, every further beat as soon as the edge is over
+ * (the latency of each beat is reported).
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef BEAT_DETECTOR_H
+#define BEAT_DETECTOR_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#define BEAT_LEARNING_TIME 2.0 // s, initial level before detecting
+#define BEAT_WINDOW 0.1 // s, moving window integration
+#define BEAT_HIGH_PASS 0.5 // Cutoff relative to minFrequency
+#define BEAT_ARTIFACT 3.0 // Edges above this times the level are no beats
+#define BEAT_THRESHOLD 0.5 // Of the beat level
+#define BEAT_LEVEL_WEIGHT 0.125 // Of a new beat in the level
+#define BEAT_LEVEL_HALF_LIFE 1.0 // s, decay without beats
+#define BEAT_ENVELOPE_HALF_LIFE 2.0 // s, of the polarity envelopes
+#define BEAT_AVERAGE 8 // Intervals of the average BPM
+
+namespace hrm
+{
+
+    struct Beat {
+        uint64_t sample = 0; // Index since reset()
+        double time = 0.0; // s since reset()
+        // Since the previous beat, 0 if not plausible (outside of the
+        // band, e.g. a missed beat) or the first beat
+        double interval = 0.0; // s
+        double bpm = 0.0; // Instantaneous (60 / interval)
+        double averageBpm = 0.0; // Over the last BEAT_AVERAGE intervals
+        // From the beat to its detection (without filter delay)
+        double latency = 0.0; // s
+    };
+
+    // Biquad, transposed direct form II
+    struct BeatFilter {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0;
+        double a1 = 0.0, a2 = 0.0;
+        double z1 = 0.0, z2 = 0.0;
+
+        double process(double x) {
+            double y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    class BeatDetector
+    {
+        private:
+            double sampleInterval; // ms
+            double minFrequency; // Hz
+            double maxFrequency;
+
+            BeatFilter highPass;
+            BeatFilter lowPass;
+            double previous = 0.0; // Filtered value
+
+            // Per sample factors of the half lifes
+            double levelDecay = 1.0;
+            double envelopeDecay = 1.0;
+
+            uint64_t sample = 0;
+            double time = 0.0; // s
+
+            // Moving window integration of the rise and fall (ring
+            // buffer of the slopes)
+            std::vector<double> window;
+            int windowPos = 0;
+            double riseSum = 0.0;
+            double fallSum = 0.0;
+
+            // Steepest rise and fall (for the polarity)
+            double riseEnvelope = 0.0;
+            double fallEnvelope = 0.0;
+            bool rising = true; // Polarity of the beat edges
+
+            double level = 0.0;
+
+            // Edge above the threshold
+            bool inEdge = false;
+            double edgeMaximum = 0.0;
+            uint64_t edgeSample = 0;
+            double edgeTime = 0.0;
+
+            bool hasBeat = false;
+            double lastBeatTime = 0.0;
+            Beat lastBeat;
+
+            // Plausible intervals (ring buffer)
+            double intervals[BEAT_AVERAGE];
+            int intervalPos = 0;
+            int intervalCount = 0;
+            double intervalSum = 0.0;
+
+            void updateCoefficients();
+            /**
+             * @retval true The edge of a beat is over.
+             */
+            bool detect();
+
+        public:
+            /**
+             * @param sampleInterval ms
+             * @param minFrequency Hz, lowest heart rate
+             * @param maxFrequency Hz, highest heart rate
+             */
+            BeatDetector(double sampleInterval, double minFrequency, double maxFrequency);
+
+            /**
+             * @retval true A beat was detected (see getLastBeat()).
+             */
+            bool addSample(double value);
+
+            /**
+             * Starts learning again.
+             */
+            void reset();
+
+            /**
+             * Resets the detector.
+             */
+            void setSampleInterval(double sampleInterval);
+            void setBand(double minFrequency, double maxFrequency);
+
+            const Beat &getLastBeat();
+
+            /**
+             * @return Average BPM, 0 if no plausible interval yet.
+             */
+            double getBpm();
+    };
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include "ChirpZ.h"
+
+#include <cmath>
+
+#ifdef _WIN32
+const static double M_PI = 3.14159265359;
+#endif
+
+namespace hrm
+{
+
+    ChirpZ::~ChirpZ()
+    {
+        free();
+    }
+
+    void ChirpZ::free()
+    {
+        fftw_free(work);
+        fftw_free(spectrum);
+        fftw_free(kernel);
+        work = nullptr;
+        spectrum = nullptr;
+        kernel = nullptr;
+    }
+
+    void ChirpZ::setup(int size, int points, double start, double step)
+    {
+        if (size == this->size && points == this->points &&
+                start == this->start && step == this->step)
+            return;
+
+        this->size = size;
+        this->points = points;
+        this->start = start;
+        this->step = step;
+
+        free();
+        fftSize = 0;
+
+        if (size <= 0 || points <= 0)
+            return;
+
+        fftSize = 1;
+        while (fftSize < size + points - 1)
+            fftSize <<= 1;
+
+        work = fftw_alloc_complex(fftSize);
+        spectrum = fftw_alloc_complex(fftSize);
+        kernel = fftw_alloc_complex(fftSize);
+
+        FFTPlanCache &cache = FFTPlanCache::instance();
+        forward = cache.getC2C(fftSize, work, spectrum, FFTW_FORWARD, 1, deterministic);
+        backward = cache.getC2C(fftSize, spectrum, work, FFTW_BACKWARD, 1, deterministic);
+
+        // W^(n^2/2) = e^(-j pi step n^2), A^-n = e^(-j 2pi start n)
+        inputChirp.resize(size);
+        for (int n = 0; n < size; ++n) {
+            double n2 = (double) n * n;
+            inputChirp[n] = std::polar(1.0, -M_PI * step * n2 - 2 * M_PI * start * n);
+        }
+
+        outputChirp.resize(points);
+        for (int k = 0; k < points; ++k) {
+            double k2 = (double) k * k;
+            outputChirp[k] = std::polar(1.0 / fftSize, -M_PI * step * k2);
+        }
+
+        // Kernel v(m) = W^(-m^2/2) for -(N-1) <= m <= M-1 (circular).
+        for (int i = 0; i < fftSize; ++i) {
+            work[i][0] = 0.0;
+            work[i][1] = 0.0;
+        }
+
+        for (int m = 0; m < points; ++m) {
+            std::complex<double> v = std::polar(1.0, M_PI * step * m * m);
+            work[m][0] = v.real();
+            work[m][1] = v.imag();
+        }
+
+        for (int m = 1; m < size; ++m) {
+            std::complex<double> v = std::polar(1.0, M_PI * step * m * m);
+            work[fftSize - m][0] = v.real();
+            work[fftSize - m][1] = v.imag();
+        }
+
+        fftw_execute_dft(forward->get(), work, kernel);
+    }
+
+    void ChirpZ::setDeterministic(bool status)
+    {
+        if (status == deterministic)
+            return;
+
+        deterministic = status;
+        // Forces the next setup().
+        size = 0;
+    }
+
+    void ChirpZ::execute(const double *in, fftw_complex *out)
+    {
+        if (fftSize == 0)
+            return;
+
+        for (int n = 0; n < size; ++n) {
+            std::complex<double> y = in[n] * inputChirp[n];
+            work[n][0] = y.real();
+            work[n][1] = y.imag();
+        }
+
+        convolve(out);
+    }
+
+    void ChirpZ::execute(const fftw_complex *in, fftw_complex *out)
+    {
+        if (fftSize == 0)
+            return;
+
+        for (int n = 0; n < size; ++n) {
+            std::complex<double> y = in[n][0] * inputChirp[n];
+            work[n][0] = y.real();
+            work[n][1] = y.imag();
+        }
+
+        convolve(out);
+    }
+
+    void ChirpZ::convolve(fftw_complex *out)
+    {
+        for (int n = size; n < fftSize; ++n) {
+            work[n][0] = 0.0;
+            work[n][1] = 0.0;
+        }
+
+        fftw_execute_dft(forward->get(), work, spectrum);
+
+        for (int i = 0; i < fftSize; ++i) {
+            double re = spectrum[i][0] * kernel[i][0] - spectrum[i][1] * kernel[i][1];
+            double im = spectrum[i][0] * kernel[i][1] + spectrum[i][1] * kernel[i][0];
+            spectrum[i][0] = re;
+            spectrum[i][1] = im;
+        }
+
+        fftw_execute_dft(backward->get(), spectrum, work);
+
+        for (int k = 0; k < points; ++k) {
+            std::complex<double> x(work[k][0], work[k][1]);
+            x *= outputChirp[k];
+            out[k][0] = x.real();
+            out[k][1] = x.imag();
+        }
+    }
+
+    int ChirpZ::getFFTSize()
+    {
+        return fftSize;
+    }
+
+}
@@ -0,0 +1,100 @@
+/**
+ * Chirp-Z (Bluestein) zoom transform.
+ *
+ * Evaluates the DFT of N real samples at M arbitrary, equally spaced
+ * frequencies (start + k * step, in cycles per sample). The cost is two
+ * complex FFTs of length L >= N + M - 1, independent of the frequency
+ * resolution, so fine resolution does not require zero padding.
+ *
+ * The chirp tables and the FFT of the convolution kernel are cached and
+ * only recalculated when the parameters change. The plans come from
+ * FFTPlanCache.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef CHIRP_Z_H
+#define CHIRP_Z_H
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "FFTPlanCache.h"
+
+#include <fftw3.h>
+
+namespace hrm
+{
+
+    class ChirpZ
+    {
+        private:
+            int size = 0; // N
+            int points = 0; // M
+            int fftSize = 0; // L
+            double start = 0.0;
+            double step = 0.0;
+            bool deterministic = false;
+
+            // x(n) * A^-n * W^(n^2/2), n < N
+            std::vector<std::complex<double>> inputChirp;
+            // W^(k^2/2) / L, k < M
+            std::vector<std::complex<double>> outputChirp;
+
+            // The cached plans are out-of-place, two work arrays.
+            fftw_complex *work = nullptr;
+            fftw_complex *spectrum = nullptr;
+            fftw_complex *kernel = nullptr; // FFT of W^(-m^2/2)
+
+            std::shared_ptr<Plan> forward;
+            std::shared_ptr<Plan> backward;
+
+            void free();
+
+            /**
+             * Multiplies the work array with the kernel, transforms back
+             * and writes the M points to out.
+             */
+            void convolve(fftw_complex *out);
+
+        public:
+            ChirpZ() {}
+            ~ChirpZ();
+
+            ChirpZ(const ChirpZ &) = delete;
+            ChirpZ &operator=(const ChirpZ &) = delete;
+
+            /**
+             * Does nothing if the parameters did not change.
+             *
+             * @param start First frequency (cycles per sample, f / fs).
+             * @param step Frequency spacing (cycles per sample).
+             */
+            void setup(int size, int points, double start, double step);
+
+            /**
+             * See FFTPlanCache::getC2C(). The next setup() gets new plans.
+             */
+            void setDeterministic(bool status);
+
+            /**
+             * @param in N real samples.
+             * @param out M complex points.
+             */
+            void execute(const double *in, fftw_complex *out);
+
+            /**
+             * Uses only the real part of the N samples.
+             */
+            void execute(const fftw_complex *in, fftw_complex *out);
+
+            /**
+             * @return Length of the internal FFTs (L).
+             */
+            int getFFTSize();
+    };
+
+}
+
+#endif
@@ -0,0 +1,853 @@
+#include "FFT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+
+namespace hrm
+{
+
+    FFT::FFT(double sampleInterval) : buffer(
+            DEFAULT_SAMPLES,
+            DEFAULT_ZERO_PADDING_SAMPLES,
+            DEFAULT_SLIDING_WINDOW), slidingDFT(1)
+    {
+        properties.maxFrequency = DEFAULT_MAX_FREQUENCY;
+        properties.minFrequency = DEFAULT_MIN_FREQUENCY;
+
+        applySampleSettings();
+        setSampleInterval(sampleInterval);
+    }
+
+    FFT::~FFT()
+    {
+        fftw_free(out);
+        freeAutocorrelation();
+    }
+
+    bool FFT::addSample(double sample)
+    {
+        if (getChannels() != 1)
+            return false;
+
+        return addSamples(&sample);
+    }
+
+    bool FFT::addSamples(const double *samples)
+    {
+        if (properties.engine == ENGINE_SLIDING_DFT)
+            return addSamplesSlidingDFT(samples);
+
+        if (buffer.add(samples)) {
+            // Got enough sample, do DFT.
+            TRACE_SCOPE("FFT::addSample");
+            bufferFullTime = Statistics::now();
+
+            // Functions for input time domain.
+            if (useWindowFunction)
+                applyWindowFunction();
+            else
+                properties.coherentGain = 1.0;
+
+            if (properties.engine == ENGINE_CHIRP_Z) {
+                // Only the band, bins outside stay zero (ideal filter).
+                executeChirpZ();
+
+                if (useScaling)
+                    scaleAndConvert(properties.firstBin, properties.lastBin);
+                else
+                    convert(properties.firstBin, properties.lastBin);
+
+                calculated = true;
+                return true;
+            }
+
+            execute();
+
+            if (useAutocorrelation)
+                savePower();
+
+            // Function for output frequency domain.
+            if (useIdealFilter)
+                idealFilter();
+            if (useScaling)
+                scaleAndConvert(1, properties.outputSize);
+            else
+                convert(1, properties.outputSize);
+
+            calculated = true; // For peak calculation
+            return true;
+        }
+
+        return false;
+    }
+
+    bool FFT::addSamplesSlidingDFT(const double *samples)
+    {
+        // The channels are filled in lockstep.
+        bool full = false;
+        for (size_t c = 0; c < slidingDFT.size(); ++c)
+            full = slidingDFT[c].add(samples[c]);
+
+        if (!full)
+            return false;
+
+        TRACE_SCOPE("FFT::addSamplesSlidingDFT");
+        bufferFullTime = Statistics::now();
+
+        properties.coherentGain = 1.0;
+
+        // Bins outside the band stay zero (ideal filter).
+        for (size_t c = 0; c < slidingDFT.size(); ++c) {
+            fftw_complex *o = getChannelOut(c);
+
+            for (int i = properties.firstBin; i <= properties.lastBin; ++i) {
+                std::complex<double> value = slidingDFT[c].getBin(i);
+                o[i][0] = value.real();
+                o[i][1] = value.imag();
+            }
+        }
+
+        if (useScaling)
+            scaleAndConvert(properties.firstBin, properties.lastBin);
+        else
+            convert(properties.firstBin, properties.lastBin);
+
+        calculated = true;
+        return true;
+    }
+
+    void FFT::execute()
+    {
+        TRACE_SCOPE("FFT::execute");
+
+        // All channels at once (batched plan).
+        // Either the estimated or the measured plan, fixed for this frame.
+        fftw_plan p = plan->get();
+
+        if (properties.type == C2C)
+            fftw_execute_dft(p, buffer.get(), out);
+        else
+            fftw_execute_dft_r2c(p, buffer.getReal(), out);
+    }
+
+    void FFT::executeChirpZ()
+    {
+        TRACE_SCOPE("FFT::executeChirpZ");
+
+        if (properties.lastBin < properties.firstBin)
+            return;
+
+        for (int c = 0; c < buffer.getChannels(); ++c) {
+            fftw_complex *o = getChannelOut(c) + properties.firstBin;
+
+            if (properties.type == C2C)
+                chirpZ.execute(buffer.get(c), o);
+            else
+                chirpZ.execute(buffer.getReal(c), o);
+        }
+    }
+
+    void FFT::applyWindowFunction()
+    {
+        TRACE_SCOPE("FFT::applyWindowFunction");
+
+        const WindowTable &table = windowFunction.get(properties.windowType,
+                                   properties.numberOfSamples,
+                                   properties.kaiserBeta);
+
+        buffer.applyWindow(table.coefficients);
+        properties.coherentGain = table.coherentGain;
+    }
+
+    void FFT::idealFilter()
+    {
+        TRACE_SCOPE("FFT::idealFilter");
+
+        for (int i = 1; i <= properties.outputSize; ++i) {
+            if (!isRequiredFrequency(i)) {
+                for (int c = 0; c < buffer.getChannels(); ++c) {
+                    fftw_complex *o = getChannelOut(c);
+                    o[i][0] = 0.0;
+                    o[i][1] = 0.0;
+                }
+            }
+        }
+    }
+
+    void FFT::scaleAndConvert(int first, int last)
+    {
+        TRACE_SCOPE("FFT::scaleAndConvert");
+
+        // Only the effective samples carry signal energy (zero padding
+        // does not), the window scales the amplitude by its coherent gain.
+        double scale = 2.0 / (properties.numberOfSamples * properties.coherentGain);
+
+        for (int c = 0; c < buffer.getChannels(); ++c) {
+            fftw_complex *o = getChannelOut(c);
+
+            // Without DC offset
+            for (int i = first; i <= last; ++i) {
+                // Complex value to magnitude
+                double scaledAmplReal = scale * o[i][0];
+                double scaledAmplImag = scale * o[i][1];
+                double magnitude = (sqrt(pow(scaledAmplReal, 2) + pow(scaledAmplImag, 2)));
+
+                outReal[c][i-1] = scaledAmplReal;
+                outImaginary[c][i-1] = scaledAmplImag;
+                outMagnitude[c][i-1] = magnitude;
+            }
+        }
+    }
+
+    void FFT::convert(int first, int last)
+    {
+        TRACE_SCOPE("FFT::convert");
+
+        for (int c = 0; c < buffer.getChannels(); ++c) {
+            fftw_complex *o = getChannelOut(c);
+
+            // Without DC offset
+            for (int i = first; i <= last; ++i) {
+                double magnitude = (sqrt(pow(o[i][0], 2) + pow(o[i][1], 2)));
+
+                outReal[c][i-1] = o[i][0];
+                outImaginary[c][i-1] = o[i][1];
+                outMagnitude[c][i-1] = magnitude;
+            }
+        }
+    }
+
+    void FFT::clearOutput()
+    {
+        int channels = buffer.getChannels();
+
+        for (int i = 0; i < outStride * channels; ++i) {
+            out[i][0] = 0.0;
+            out[i][1] = 0.0;
+        }
+
+        outReal.resize(channels);
+        outImaginary.resize(channels);
+        outMagnitude.resize(channels);
+
+        for (int c = 0; c < channels; ++c) {
+            outReal[c].assign(properties.outputSize, 0.0);
+            outImaginary[c].assign(properties.outputSize, 0.0);
+            outMagnitude[c].assign(properties.outputSize, 0.0);
+        }
+
+        outPower.clear();
+        calculated = false;
+    }
+
+    void FFT::updateBand()
+    {
+        if (properties.totalSamples <= 0 || properties.sampleRate <= 0.0)
+            return;
+
+        double binsPerHz = properties.totalSamples / properties.sampleRate;
+
+        properties.firstBin = std::max(1, (int) ceil(properties.minFrequency * binsPerHz));
+        properties.lastBin = std::min(properties.outputSize,
+                                      (int) floor(properties.maxFrequency * binsPerHz));
+
+        // The zoom points lie on the grid of the zero padded FFT.
+        properties.zoomPoints = std::max(0, properties.lastBin - properties.firstBin + 1);
+        properties.zoomResolution = properties.frequencyResolutionWithZeroPadding;
+
+        if (properties.engine == ENGINE_SLIDING_DFT) {
+            for (SlidingDFT &channel : slidingDFT)
+                channel.setup(properties.numberOfSamples, properties.totalSamples,
+                              properties.firstBin, properties.lastBin);
+            clearOutput();
+        } else if (properties.engine == ENGINE_CHIRP_Z) {
+            chirpZ.setup(properties.numberOfSamples, properties.zoomPoints,
+                         properties.firstBin / (double) properties.totalSamples,
+                         1.0 / properties.totalSamples);
+            properties.zoomFFTSize = chirpZ.getFFTSize();
+            clearOutput();
+        }
+    }
+
+    void FFT::setSampleInterval(double sampleInterval)
+    {
+        properties.sampleInterval = sampleInterval;
+
+        properties.sampleRate = 1.0 / (sampleInterval / 1000.0);
+        properties.segmentDuration = properties.numberOfSamples * sampleInterval;
+        properties.frequencyResolution = properties.sampleRate / properties.numberOfSamples;
+        properties.frequencyResolutionWithZeroPadding = properties.sampleRate / properties.totalSamples;
+
+        updateBand();
+    }
+
+    void FFT::setSampleSettings(int effective, int zeroPad, int window)
+    {
+        buffer.setSize(effective, zeroPad, window);
+        applySampleSettings();
+        // Update the other properties
+        setSampleInterval(properties.sampleInterval);
+    }
+
+    void FFT::applySampleSettings()
+    {
+        TRACE_SCOPE("FFT::applySampleSettings");
+
+        properties.numberOfSamples = buffer.getSize();
+        properties.zeroPaddingSamples = buffer.getZeroPadSize();
+        properties.slidingWindow = buffer.getWindowSize();
+        properties.totalSamples = buffer.getTotalSize();
+        // Without DC offset and only positive frequencies.
+        properties.outputSize = properties.totalSamples / 2;
+
+        if (out != nullptr)
+            fftw_free(out);
+        freeAutocorrelation();
+
+        FFTPlanCache &cache = FFTPlanCache::instance();
+        int channels = buffer.getChannels();
+
+        // N (C2C) or N/2+1 (R2C) elements per channel
+        if (properties.type == C2C) {
+            outStride = properties.totalSamples;
+            out = fftw_alloc_complex(outStride * channels);
+            plan = cache.getC2C(properties.totalSamples, buffer.get(), out,
+                                FFTW_FORWARD, channels, deterministic);
+        } else {
+            outStride = properties.totalSamples / 2 + 1;
+            out = fftw_alloc_complex(outStride * channels);
+            plan = cache.getR2C(properties.totalSamples, buffer.getReal(), out, channels,
+                                deterministic);
+        }
+
+        clearOutput();
+    }
+
+    void FFT::freeAutocorrelation()
+    {
+        fftw_free(power);
+        fftw_free(correlation);
+        power = nullptr;
+        correlation = nullptr;
+        inversePlan.reset();
+    }
+
+    void FFT::setUseFilter(bool status)
+    {
+        useIdealFilter = status;
+    }
+
+    void FFT::setUseWindowFunction(bool status)
+    {
+        useWindowFunction = status;
+    }
+
+    void FFT::setWindowType(WINDOW_TYPE type, double beta)
+    {
+        properties.windowType = type;
+        properties.kaiserBeta = beta;
+    }
+
+    void FFT::setUseScaling(bool status)
+    {
+        useScaling = status;
+    }
+
+    void FFT::setType(FFT_TYPE type)
+    {
+        if (type == properties.type)
+            return;
+
+        properties.type = type;
+        calculated = false;
+
+        buffer.setComplex(type == C2C);
+        applySampleSettings();
+    }
+
+    void FFT::setEngine(SPECTRUM_ENGINE engine)
+    {
+        if (engine == properties.engine)
+            return;
+
+        properties.engine = engine;
+
+        buffer.setSize(properties.numberOfSamples,
+                       properties.zeroPaddingSamples,
+                       properties.slidingWindow);
+        clearOutput();
+        updateBand();
+    }
+
+    void FFT::setDeterministic(bool status)
+    {
+        if (status == deterministic)
+            return;
+
+        deterministic = status;
+        calculated = false;
+
+        chirpZ.setDeterministic(status);
+        applySampleSettings();
+        updateBand();
+    }
+
+    void FFT::setChannels(int channels)
+    {
+        channels = std::max(1, std::min((int) SENSOR_CHANNELS, channels));
+        if (channels == buffer.getChannels())
+            return;
+
+        calculated = false;
+
+        buffer.setChannels(channels);
+        slidingDFT.resize(channels);
+
+        applySampleSettings();
+        updateBand();
+    }
+
+    int FFT::getChannels()
+    {
+        return buffer.getChannels();
+    }
+
+    void FFT::setPeakInterpolation(PEAK_INTERPOLATION interpolation)
+    {
+        peakInterpolation = interpolation;
+    }
+
+    uint64_t FFT::getBufferFullTime()
+    {
+        return bufferFullTime;
+    }
+
+    Peak FFT::getPeak(int channel)
+    {
+        TRACE_SCOPE("FFT::getPeak");
+
+        if (!calculated || channel < 0 || channel >= buffer.getChannels())
+            return Peak();
+
+        return findPeak(outMagnitude[channel], &outReal[channel], &outImaginary[channel]);
+    }
+
+    Peak FFT::getCombinedPeak()
+    {
+        TRACE_SCOPE("FFT::getCombinedPeak");
+
+        if (!calculated)
+            return Peak();
+
+        // Sum of the relative (AC/DC) spectra, so no channel dominates
+        // because of its brightness.
+        combinedMagnitude.assign(properties.outputSize, 0.0);
+
+        for (int c = 0; c < buffer.getChannels(); ++c) {
+            double dc = fabs(getMean(c));
+            if (dc == 0.0)
+                continue;
+
+            for (int i = properties.firstBin; i <= properties.lastBin; ++i)
+                combinedMagnitude[i-1] += outMagnitude[c][i-1] / dc;
+        }
+
+        return findPeak(combinedMagnitude, nullptr, nullptr);
+    }
+
+    AutocorrelationPeak FFT::getAutocorrelationPeak(int channel)
+    {
+        TRACE_SCOPE("FFT::getAutocorrelationPeak");
+
+        AutocorrelationPeak peak;
+
+        if (!calculated || channel < 0 || channel >= (int) outPower.size())
+            return peak;
+
+        int n = properties.totalSamples;
+
+        // Lags of the band, with a neighbour on both sides (for the
+        // interpolation) that still overlaps the effective samples.
+        int minLag = std::max(2, (int) floor(properties.sampleRate / properties.maxFrequency));
+        int maxLag = std::min(std::min(properties.numberOfSamples, n / 2) - 2,
+                              (int) ceil(properties.sampleRate / properties.minFrequency));
+
+        if (maxLag <= minLag)
+            return peak;
+
+        if (correlation == nullptr) {
+            power = fftw_alloc_complex(n / 2 + 1);
+            correlation = fftw_alloc_real(n);
+            inversePlan = FFTPlanCache::instance().getC2R(n, power, correlation, 1,
+                          deterministic);
+        }
+
+        const std::vector<double> &p = outPower[channel];
+        for (int i = 0; i <= n / 2; ++i) {
+            power[i][0] = p[i];
+            power[i][1] = 0.0;
+        }
+
+        fftw_execute_dft_c2r(inversePlan->get(), power, correlation);
+
+        if (correlation[0] <= 0.0)
+            return peak;
+
+        updateWindowCorrelation(maxLag + 2);
+
+        while (maxLag > minLag &&
+                windowCorrelation[maxLag + 1] < AUTOCORRELATION_MIN_OVERLAP * windowCorrelation[0])
+            --maxLag;
+
+        if (maxLag <= minLag)
+            return peak;
+
+        // The correction amplifies the error at small overlaps, no lag
+        // can correlate better than lag 0.
+        lagCorrelation.resize(maxLag + 2);
+        for (int k = minLag - 1; k <= maxLag + 1; ++k) {
+            lagCorrelation[k] = std::min(1.0, (correlation[k] / correlation[0]) *
+                                         (windowCorrelation[0] / windowCorrelation[k]));
+        }
+
+        // Local maxima: the highest one, then the shortest lag close to it
+        double best = 0.0;
+        for (int k = minLag; k <= maxLag; ++k) {
+            double c = lagCorrelation[k];
+            if (c > lagCorrelation[k-1] && c >= lagCorrelation[k+1] && c > best)
+                best = c;
+        }
+
+        if (best <= 0.0)
+            return peak;
+
+        int lag = minLag;
+        for (; lag <= maxLag; ++lag) {
+            double c = lagCorrelation[lag];
+            if (c > lagCorrelation[lag-1] && c >= lagCorrelation[lag+1] &&
+                    c >= AUTOCORRELATION_OCTAVE * best)
+                break;
+        }
+
+        double a = lagCorrelation[lag-1];
+        double b = lagCorrelation[lag];
+        double c = lagCorrelation[lag+1];
+        double denominator = a - 2 * b + c;
+
+        if (denominator != 0.0)
+            peak.offset = std::max(-0.5, std::min(0.5, 0.5 * (a - c) / denominator));
+
+        peak.lag = lag;
+        peak.frequency = properties.sampleRate / (lag + peak.offset);
+        peak.correlation = b - 0.25 * (a - c) * peak.offset;
+
+        return peak;
+    }
+
+    void FFT::savePower()
+    {
+        TRACE_SCOPE("FFT::savePower");
+
+        int half = properties.totalSamples / 2;
+        int first = std::max(1, properties.firstBin);
+
+        outPower.resize(buffer.getChannels());
+
+        // Both types have the positive bins first. Without DC and the
+        // slow baseline.
+        for (int c = 0; c < buffer.getChannels(); ++c) {
+            fftw_complex *o = getChannelOut(c);
+            std::vector<double> &p = outPower[c];
+
+            p.assign(half + 1, 0.0);
+            for (int i = first; i <= half; ++i)
+                p[i] = o[i][0] * o[i][0] + o[i][1] * o[i][1];
+        }
+    }
+
+    void FFT::updateWindowCorrelation(int lags)
+    {
+        int type = useWindowFunction ? (int) properties.windowType : -1;
+        int samples = properties.numberOfSamples;
+
+        if (type == correlationWindowType && properties.kaiserBeta == correlationBeta &&
+                samples == correlationSamples && (int) windowCorrelation.size() >= lags)
+            return;
+
+        TRACE_SCOPE("FFT::updateWindowCorrelation");
+
+        std::vector<double> rectangular;
+        const std::vector<double> *w = &rectangular;
+
+        if (useWindowFunction)
+            w = &windowFunction.get(properties.windowType, samples,
+                                    properties.kaiserBeta).coefficients;
+        else
+            rectangular.assign(samples, 1.0);
+
+        windowCorrelation.assign(lags, 0.0);
+        for (int k = 0; k < lags && k < samples; ++k) {
+            for (int i = 0; i + k < samples; ++i)
+                windowCorrelation[k] += (*w)[i] * (*w)[i + k];
+        }
+
+        correlationWindowType = type;
+        correlationBeta = properties.kaiserBeta;
+        correlationSamples = samples;
+    }
+
+    void FFT::setUseAutocorrelation(bool status)
+    {
+        useAutocorrelation = status;
+        outPower.clear();
+    }
+
+    bool FFT::isUsingAutocorrelation()
+    {
+        return useAutocorrelation;
+    }
+
+    double FFT::getRatio(int numerator, int denominator, int bin)
+    {
+        if (!calculated || bin < properties.firstBin || bin > properties.lastBin ||
+                numerator < 0 || numerator >= buffer.getChannels() ||
+                denominator < 0 || denominator >= buffer.getChannels())
+            return 0.0;
+
+        double acN = outMagnitude[numerator][bin-1];
+        double acD = outMagnitude[denominator][bin-1];
+        double dcN = getMean(numerator);
+        double dcD = getMean(denominator);
+
+        if (acD == 0.0 || dcN == 0.0 || dcD == 0.0)
+            return 0.0;
+
+        return (acN / dcN) / (acD / dcD);
+    }
+
+    Peak FFT::findPeak(const std::vector<double> &magnitude,
+                       const std::vector<double> *real,
+                       const std::vector<double> *imaginary)
+    {
+        Peak peak;
+
+        double max = -1 * std::numeric_limits<double>::max();
+        int indexMax = 0;
+
+        // Only the required frequencies
+        for (int i = properties.firstBin; i <= properties.lastBin; ++i) {
+            if (magnitude[i-1] > max) {
+                max = magnitude[i-1];
+                indexMax = i;
+            }
+        }
+
+        if (indexMax == 0)
+            return peak;
+
+        // Highest other local maximum
+        double second = 0.0;
+        for (int i = properties.firstBin + 1; i < properties.lastBin; ++i) {
+            if (i == indexMax)
+                continue;
+
+            double m = magnitude[i-1];
+            if (m > magnitude[i-2] && m >= magnitude[i] && m > second)
+                second = m;
+        }
+
+        peak.index = indexMax;
+        peak.magnitude = max;
+        peak.offset = interpolatePeak(indexMax, &peak.magnitude, magnitude, real, imaginary);
+        peak.frequency = indexToFrequency(indexMax + peak.offset);
+        peak.confidence = max > 0.0 ? 1.0 - second / max : 0.0;
+
+        return peak;
+    }
+
+    double FFT::interpolatePeak(int k, double *peakMagnitude,
+                                const std::vector<double> &magnitude,
+                                const std::vector<double> *real,
+                                const std::vector<double> *imaginary)
+    {
+        PEAK_INTERPOLATION interpolation = peakInterpolation;
+
+        // Jacobsen needs the complex values.
+        if (interpolation == PEAK_JACOBSEN && (!real || !imaginary))
+            interpolation = PEAK_PARABOLIC;
+
+        // Both neighbours have to be inside the band (the others are
+        // filtered).
+        if (interpolation == PEAK_NONE ||
+                k - 1 < properties.firstBin || k + 1 > properties.lastBin)
+            return 0.0;
+
+        double a = magnitude[k-2];
+        double b = magnitude[k-1];
+        double c = magnitude[k];
+        double offset = 0.0;
+
+        switch (interpolation) {
+        case PEAK_PARABOLIC: {
+            double denominator = a - 2 * b + c;
+            if (denominator != 0.0)
+                offset = 0.5 * (a - c) / denominator;
+            break;
+        }
+        case PEAK_GAUSSIAN: {
+            if (a <= 0.0 || b <= 0.0 || c <= 0.0)
+                return 0.0;
+
+            a = log(a);
+            b = log(b);
+            c = log(c);
+
+            double denominator = a - 2 * b + c;
+            if (denominator != 0.0)
+                offset = 0.5 * (a - c) / denominator;
+            break;
+        }
+        case PEAK_JACOBSEN: {
+            std::complex<double> xa((*real)[k-2], (*imaginary)[k-2]);
+            std::complex<double> xb((*real)[k-1], (*imaginary)[k-1]);
+            std::complex<double> xc((*real)[k], (*imaginary)[k]);
+
+            std::complex<double> denominator = 2.0 * xb - xa - xc;
+            if (std::abs(denominator) > 0.0)
+                offset = ((xa - xc) / denominator).real();
+            break;
+        }
+        case PEAK_NONE:
+            break;
+        }
+
+        offset = std::max(-0.5, std::min(0.5, offset));
+
+        // Height of the parabola at the offset
+        if (interpolation == PEAK_GAUSSIAN)
+            *peakMagnitude = exp(b - 0.25 * (a - c) * offset);
+        else
+            *peakMagnitude = b - 0.25 * (a - c) * offset;
+
+        return offset;
+    }
+
+    double FFT::indexToFrequency(double i)
+    {
+        return properties.sampleRate * (i / (double) properties.totalSamples);
+    }
+
+    bool FFT::isRequiredFrequency(int index)
+    {
+        double f = indexToFrequency(index);
+
+        if (f < properties.minFrequency ||
+                f > properties.maxFrequency)
+            return false;
+        return true;
+    }
+
+    fftw_complex *FFT::getIn()
+    {
+        return buffer.get();
+    }
+
+    double *FFT::getInReal()
+    {
+        return buffer.getReal();
+    }
+
+    double FFT::getInValue(int i, int channel)
+    {
+        if (properties.engine == ENGINE_SLIDING_DFT)
+            return slidingDFT[channel].getValue(i);
+
+        return buffer.getValue(i, channel);
+    }
+
+    double FFT::getMean(int channel)
+    {
+        if (properties.engine == ENGINE_SLIDING_DFT)
+            return slidingDFT[channel].getMean();
+
+        return buffer.getMean(channel);
+    }
+
+    fftw_complex *FFT::getChannelOut(int channel)
+    {
+        return out + channel * outStride;
+    }
+
+    fftw_complex *FFT::getOut(int channel)
+    {
+        if (calculated)
+            return getChannelOut(channel);
+        return nullptr;
+    }
+
+    std::vector<double>& FFT::getMagnitude(int channel)
+    {
+        return outMagnitude[channel];
+    }
+
+    std::vector<double>& FFT::getRealPart(int channel)
+    {
+        return outReal[channel];
+    }
+
+    std::vector<double>& FFT::getImaginaryPart(int channel)
+    {
+        return outImaginary[channel];
+    }
+
+    FFT_properties FFT::getProperties()
+    {
+        return properties;
+    }
+
+    FFT_settings FFT::getSettings()
+    {
+        FFT_settings settings;
+
+        settings.numberOfSamples = properties.numberOfSamples;
+        settings.zeroPaddingSamples = properties.zeroPaddingSamples;
+        settings.slidingWindow = properties.slidingWindow;
+        settings.channels = getChannels();
+        settings.type = properties.type;
+        settings.engine = properties.engine;
+        settings.useWindowFunction = useWindowFunction;
+        settings.windowType = properties.windowType;
+        settings.kaiserBeta = properties.kaiserBeta;
+        settings.useIdealFilter = useIdealFilter;
+        settings.useScaling = useScaling;
+        settings.useAutocorrelation = useAutocorrelation;
+        settings.peakInterpolation = peakInterpolation;
+
+        return settings;
+    }
+
+    void FFT::setSettings(const FFT_settings &settings)
+    {
+        setChannels(settings.channels);
+        setType(settings.type);
+        setEngine(settings.engine);
+
+        if (settings.numberOfSamples != properties.numberOfSamples ||
+                settings.zeroPaddingSamples != properties.zeroPaddingSamples ||
+                settings.slidingWindow != properties.slidingWindow)
+            setSampleSettings(settings.numberOfSamples, settings.zeroPaddingSamples,
+                              settings.slidingWindow);
+
+        setUseWindowFunction(settings.useWindowFunction);
+        setWindowType(settings.windowType, settings.kaiserBeta);
+        setUseFilter(settings.useIdealFilter);
+        setUseScaling(settings.useScaling);
+        if (settings.useAutocorrelation != useAutocorrelation)
+            setUseAutocorrelation(settings.useAutocorrelation);
+        setPeakInterpolation(settings.peakInterpolation);
+    }
+
+}
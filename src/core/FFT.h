@@ -0,0 +1,483 @@
+/**
+ * The class FFT executes the signal processing steps to determine the
+ * heart rate.
+ *
+ * It can process several channels (e.g. broadband and IR) in lockstep:
+ * The channels share one buffer layout and one batched FFTW plan, so a
+ * frame of all channels is a single transform. Every channel has its
+ * own spectrum and peak. Methods without channel parameter refer to
+ * channel 0.
+ *
+ * Besides the spectral peak, the heart rate can be estimated from the
+ * autocorrelation (see getAutocorrelationPeak()). It is not fooled by
+ * a strong harmonic, as all harmonics add up at the lag of the pulse
+ * period.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <memory>
+
+#include "ChirpZ.h"
+#include "FFTBuffer.h"
+#include "FFTPlanCache.h"
+#include "SensorProtocol.h"
+#include "SlidingDFT.h"
+#include "Statistics.h"
+#include "Trace.h"
+#include "WindowFunction.h"
+
+#include <fftw3.h>
+
+// Default values
+#define DEFAULT_TOTAL_SAMPLES 1024 // power of 2
+#define DEFAULT_SAMPLES 128
+#define DEFAULT_SLIDING_WINDOW 5
+
+#define DEFAULT_ZERO_PADDING_SAMPLES (DEFAULT_TOTAL_SAMPLES - DEFAULT_SAMPLES)
+
+#define DEFAULT_MIN_FREQUENCY 0.7 // Hz
+#define DEFAULT_MAX_FREQUENCY 3.9 // Hz
+
+// The shortest lag with a maximum above this fraction of the highest
+// one is taken (no multiples of the period).
+#define AUTOCORRELATION_OCTAVE 0.8
+// Longer lags overlap too little of the windowed frame (relative to
+// lag 0), they are not searched.
+#define AUTOCORRELATION_MIN_OVERLAP 0.25
+
+namespace hrm
+{
+
+    /**
+     * ENGINE_FFTW: Windowed FFT over the full (zero padded) frame every
+     * slidingWindow samples.
+     * ENGINE_SLIDING_DFT: Only the bins between min and max frequency are
+     * updated on every sample (no window function).
+     * ENGINE_CHIRP_Z: Zoom transform of the bins between min and max
+     * frequency every slidingWindow samples. The zero padding only
+     * determines the resolution, the padded samples are not transformed.
+     */
+    enum SPECTRUM_ENGINE {ENGINE_FFTW, ENGINE_SLIDING_DFT, ENGINE_CHIRP_Z};
+
+    /**
+     * Interpolation of the peak between the bins.
+     * PEAK_PARABOLIC: Parabola through the magnitudes (default).
+     * PEAK_GAUSSIAN: Parabola through the log magnitudes.
+     * PEAK_JACOBSEN: Jacobsens' estimator on the complex values.
+     */
+    enum PEAK_INTERPOLATION {PEAK_NONE, PEAK_PARABOLIC, PEAK_GAUSSIAN, PEAK_JACOBSEN};
+
+    struct Peak {
+        int index = -1; // Bin of the maximum, -1 if not calculated
+        double offset = 0.0; // Interpolated offset to index (-0.5 .. 0.5 bins)
+        double frequency = 0.0; // Hz (interpolated)
+        double magnitude = 0.0; // (interpolated)
+
+        // 1 - (second highest local maximum / peak) in the band.
+        // 0: ambiguous, 1: single peak.
+        double confidence = 0.0;
+    };
+
+    struct AutocorrelationPeak {
+        int lag = -1; // Samples, -1 if not calculated
+        double offset = 0.0; // Interpolated offset to lag (-0.5 .. 0.5)
+        double frequency = 0.0; // Hz (interpolated)
+        // Normalized to lag 0 and corrected for the window.
+        // 1: periodic signal.
+        double correlation = 0.0;
+    };
+
+    struct FFT_properties {
+        int numberOfSamples = 0;
+        int zeroPaddingSamples = 0;
+        int totalSamples = 0; // N (numberOfSamples + zeroPaddingSamples)
+        int outputSize = 0; // totalSamples / 2 (only positive frequencies)
+
+        FFT_TYPE type = R2C;
+        SPECTRUM_ENGINE engine = ENGINE_FFTW;
+
+        WINDOW_TYPE windowType = HAMMING;
+        double kaiserBeta = DEFAULT_KAISER_BETA;
+        // Amplitude correction of the window (1.0 without window).
+        double coherentGain = 1.0;
+
+        int slidingWindow = 0;
+
+        // Set from outside.
+        double sampleInterval = 0.0; // delta x
+        // Determines:
+        double sampleRate = 0.0; // Hz
+        double segmentDuration = 0.0; // ms
+        double frequencyResolution = 0.0; // Hz
+        double frequencyResolutionWithZeroPadding = 0.0; // Hz
+
+        // What to use for ideal bandpass filter.
+        double minFrequency = 0.0; // Hz
+        double maxFrequency = 0.0; // Hz
+
+        // Bins between min and max frequency.
+        int firstBin = 1;
+        int lastBin = 0;
+
+        // Chirp-Z: Number of points in the band, their spacing and the
+        // length of the internal FFTs.
+        int zoomPoints = 0;
+        double zoomResolution = 0.0; // Hz
+        int zoomFFTSize = 0;
+    };
+
+    // Everything set from outside except the sample interval, to
+    // configure a new FFT like an existing one.
+    struct FFT_settings {
+        int numberOfSamples = DEFAULT_SAMPLES;
+        int zeroPaddingSamples = DEFAULT_ZERO_PADDING_SAMPLES;
+        int slidingWindow = DEFAULT_SLIDING_WINDOW;
+        int channels = 1;
+
+        FFT_TYPE type = R2C;
+        SPECTRUM_ENGINE engine = ENGINE_FFTW;
+
+        bool useWindowFunction = true;
+        WINDOW_TYPE windowType = HAMMING;
+        double kaiserBeta = DEFAULT_KAISER_BETA;
+
+        bool useIdealFilter = true;
+        bool useScaling = true;
+        bool useAutocorrelation = false;
+        PEAK_INTERPOLATION peakInterpolation = PEAK_PARABOLIC;
+    };
+
+    class FFT
+    {
+        private:
+            FFT_properties properties;
+
+            // Shared with FFTPlanCache, hot-swapped when the measured
+            // plan is ready.
+            std::shared_ptr<Plan> plan;
+            // outStride elements per channel
+            fftw_complex *out = nullptr;
+            int outStride = 0; // N/2+1 (R2C) or N (C2C)
+            FFTBuffer buffer;
+            WindowFunction windowFunction;
+            std::vector<SlidingDFT> slidingDFT; // Per channel
+            ChirpZ chirpZ;
+
+            // Per channel
+            std::vector<std::vector<double>> outMagnitude;
+            std::vector<std::vector<double>> outReal;
+            std::vector<std::vector<double>> outImaginary;
+
+            // See getCombinedPeak()
+            std::vector<double> combinedMagnitude;
+
+            // See getAutocorrelationPeak()
+            // Per channel, bins 0 to N/2 (before the ideal filter)
+            std::vector<std::vector<double>> outPower;
+            // Allocated on first use
+            std::shared_ptr<Plan> inversePlan;
+            fftw_complex *power = nullptr; // N/2+1
+            double *correlation = nullptr; // N
+            std::vector<double> lagCorrelation;
+            // Autocorrelation of the window per lag and its settings
+            std::vector<double> windowCorrelation;
+            int correlationWindowType = -1; // -1: rectangular
+            double correlationBeta = 0.0;
+            int correlationSamples = 0;
+
+            bool useWindowFunction = true;
+            bool useIdealFilter = true;
+            bool useScaling = true;
+            bool useAutocorrelation = false;
+            bool deterministic = false;
+            bool calculated = false;
+            uint64_t bufferFullTime = 0; // Statistics::now()
+
+            PEAK_INTERPOLATION peakInterpolation = PEAK_PARABOLIC;
+
+            /**
+             * Maximum between min and max frequency of the spectrum.
+             * Without real/imaginary part, Jacobsen falls back to the
+             * parabolic interpolation.
+             */
+            Peak findPeak(const std::vector<double> &magnitude,
+                          const std::vector<double> *real,
+                          const std::vector<double> *imaginary);
+
+            /**
+             * @return Offset of the true peak to bin k (-0.5 .. 0.5).
+             */
+            double interpolatePeak(int k, double *peakMagnitude,
+                                   const std::vector<double> &magnitude,
+                                   const std::vector<double> *real,
+                                   const std::vector<double> *imaginary);
+
+            fftw_complex *getChannelOut(int channel);
+
+            /**
+             * Keeps the power spectrum above min frequency (for the
+             * autocorrelation).
+             */
+            void savePower();
+
+            /**
+             * Autocorrelation of the window of the last frame for the
+             * lags 0 to lags-1 (only recalculated if the window
+             * changed).
+             */
+            void updateWindowCorrelation(int lags);
+
+            /**
+             * Frees the autocorrelation arrays (size changed).
+             */
+            void freeAutocorrelation();
+
+            /**
+             * Multiplicates the time domain input signal with the
+             * selected window function (to weak the leakage effect).
+             */
+            void applyWindowFunction();
+
+            /**
+             * Executes the plan on the current buffer arrays.
+             */
+            void execute();
+
+            /**
+             * Ideal filter to remove unwanted frequencies.
+             */
+            void idealFilter();
+
+            /**
+             * Zoom transform of the band bins to the output array.
+             */
+            void executeChirpZ();
+
+            /**
+             * Sliding DFT step: writes the band bins to the output array.
+             */
+            bool addSamplesSlidingDFT(const double *samples);
+
+            /**
+             * Scales the frequency values (bins first to last) to
+             * represent the correct amplitude and converts the
+             * rectangular data to polar coordinates. (+ and - frequency,
+             * both for the complex fft and the half-spectrum of the
+             * real fft).
+             */
+            void scaleAndConvert(int first, int last);
+
+            /**
+             * Only converts the rectangular data (bins first to last)
+             * to polar coordinates.
+             */
+            void convert(int first, int last);
+
+            /**
+             * Clears the output arrays.
+             */
+            void clearOutput();
+
+            /**
+             * Determines the bins between min and max frequency and
+             * prepares the sliding DFT for them.
+             */
+            void updateBand();
+
+            /**
+             * Applies the buffer settings to the fft output settings.
+             * (Number of samples used for FFT)
+             */
+            void applySampleSettings();
+
+        public:
+            FFT(double sampleInterval);
+            ~FFT();
+
+            /**
+             * Ad a sample to the internal buffer. When N (max sample size)
+             * is reached, calculate the DFT.
+             *
+             * @retval true Got enough data and calculated the DFT.
+             * @retval false Not enough data to calculate the DFT (or
+             * more than one channel).
+             */
+            bool addSample(double sample);
+
+            /**
+             * Adds one sample per channel (see addSample()). A frame of
+             * all channels is calculated at once.
+             */
+            bool addSamples(const double *samples);
+
+            /**
+             * Number of channels processed in lockstep (default 1, at
+             * most SENSOR_CHANNELS). Clears the sample buffers.
+             */
+            void setChannels(int channels);
+            int getChannels();
+
+            /**
+             * Is required to calculate the peak.
+             */
+            void setSampleInterval(double sampleInterval);
+
+            void setSampleSettings(int effective, int zeroPad, int window);
+
+            void setUseFilter(bool status);
+
+            void setUseWindowFunction(bool status);
+
+            /**
+             * @param beta Only used for the Kaiser window.
+             */
+            void setWindowType(WINDOW_TYPE type, double beta = DEFAULT_KAISER_BETA);
+
+            void setUseScaling(bool status);
+
+            /**
+             * Switches between the real (r2c) and complex (c2c) transform.
+             * Clears the sample buffer.
+             */
+            void setType(FFT_TYPE type);
+
+            /**
+             * Switches the spectral engine. Clears the sample buffers.
+             */
+            void setEngine(SPECTRUM_ENGINE engine);
+
+            /**
+             * Only plans that do not depend on timing or on the FFTW
+             * wisdom (see FFTPlanCache::getR2C()), for bit-identical
+             * replays. Default false.
+             */
+            void setDeterministic(bool status);
+
+            void setPeakInterpolation(PEAK_INTERPOLATION interpolation);
+
+            /**
+             * @return The (interpolated) maximum between min and max
+             * frequency. Peak::index is -1 if nothing was calculated yet.
+             */
+            Peak getPeak(int channel = 0);
+
+            /**
+             * Peak of the summed relative (AC/DC) spectra of all
+             * channels. Uses the spectra calculated already, no second
+             * transform.
+             */
+            Peak getCombinedPeak();
+
+            /**
+             * Heart rate from the autocorrelation of the last frame
+             * (Wiener-Khinchin): The power spectrum of the forward
+             * transform (above min frequency, without the ideal filter,
+             * whose edges would smear the lags) is transformed back with
+             * a cached inverse plan, a single transform per call. Only
+             * the lags of the band are searched. The bias of the window
+             * (less overlap at longer lags) is divided out.
+             *
+             * The lags are circular: Without zero padding of at least
+             * the longest lag, they wrap around.
+             *
+             * @return AutocorrelationPeak::lag is -1 if not enabled
+             * (see setUseAutocorrelation()), nothing was calculated yet,
+             * the engine is not ENGINE_FFTW or the frame is too short
+             * for the band.
+             */
+            AutocorrelationPeak getAutocorrelationPeak(int channel = 0);
+
+            /**
+             * Keeps the power spectrum of each frame for
+             * getAutocorrelationPeak() (ENGINE_FFTW only).
+             */
+            void setUseAutocorrelation(bool status);
+            bool isUsingAutocorrelation();
+
+            /**
+             * Ratio of ratios (AC/DC of numerator) / (AC/DC of
+             * denominator) at the bin, e.g. the peak bin. Used for
+             * pulse oximetry like estimators.
+             *
+             * @return 0 if not available.
+             */
+            double getRatio(int numerator, int denominator, int bin);
+
+            /**
+             * @return The DC level (mean) removed from the last frame
+             * of the channel.
+             */
+            double getMean(int channel = 0);
+
+            /**
+             * @return Statistics::now() when the samples of the last
+             * spectrum were complete (before the transform).
+             */
+            uint64_t getBufferFullTime();
+
+            double indexToFrequency(double i);
+
+            /**
+            * Checks if the given index from a frequency spectrum is
+            * a required frequency based on the min and max frequency
+            * variable.
+            *
+            * @retval true The frequency is required
+            * @retval false The frequency is not required (can be removed)
+            */
+            bool isRequiredFrequency(int index);
+
+            /**
+             * @return Input array held by FFTBuffer (C2C only, else nullptr).
+             */
+            fftw_complex *getIn();
+
+            /**
+             * @return Input array held by FFTBuffer (R2C only, else nullptr).
+             */
+            double *getInReal();
+
+            /**
+             * @return Value with index i of the input array (both types).
+             */
+            double getInValue(int i, int channel = 0);
+
+            fftw_complex *getOut(int channel = 0);
+
+            /**
+             * @return The magnitude of the polar coordiantes without
+             * the DC offset and only the positive frequency part.
+             * This means it is (N/2) long.
+             */
+            std::vector<double>& getMagnitude(int channel = 0);
+
+            /**
+             * @return the real (cos) scaled positive part of the frequencies.
+             * This means it is (N/2) long.
+             */
+            std::vector<double>& getRealPart(int channel = 0);
+
+            /**
+             * @return the imaginary (sin) scaled positive part of the frequencies.
+             * This means it is (N/2) long.
+             */
+            std::vector<double>& getImaginaryPart(int channel = 0);
+
+            FFT_properties getProperties();
+
+            FFT_settings getSettings();
+
+            /**
+             * Only changed values are applied, so the sample buffers are
+             * only cleared if a setter would clear them.
+             */
+            void setSettings(const FFT_settings &settings);
+    };
+
+}
+
+#endif
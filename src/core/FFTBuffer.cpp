@@ -0,0 +1,252 @@
+#include "FFTBuffer.h"
+
+#include <algorithm>
+
+namespace hrm
+{
+
+    FFTBuffer::FFTBuffer(int effective, int zeroPad, int window)
+    {
+        setSize(effective, zeroPad, window);
+    }
+
+    FFTBuffer::~FFTBuffer()
+    {
+        fftw_free(dataOut);
+        fftw_free(realOut);
+    }
+
+    bool FFTBuffer::add(double p_data)
+    {
+        return add(&p_data);
+    }
+
+    bool FFTBuffer::add(const double *samples)
+    {
+        double *slot = &data[(head & mask) * channels];
+
+        for (int c = 0; c < channels; ++c) {
+            slot[c] = samples[c];
+            sum[c] += samples[c];
+        }
+
+        ++head;
+        ++count;
+
+        if (count == effectiveSize) {
+            // Also normalizes with the mean.
+            copyToDataOut();
+
+            drop(std::min(windowSize, effectiveSize));
+
+            // Zero pad the other values.
+            zeroPad();
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void FFTBuffer::copyToDataOut()
+    {
+        if (count != effectiveSize)
+            return;
+
+        uint64_t tail = head - count;
+
+        for (int c = 0; c < channels; ++c) {
+            double m = sum[c] / count;
+            mean[c] = m;
+
+            if (complex) {
+                fftw_complex *out = dataOut + c * totalSize;
+
+                for (int i = 0; i < effectiveSize; ++i) {
+                    out[i][0] = data[((tail + i) & mask) * channels + c] - m;
+                    out[i][1] = 0.0;
+                }
+            } else {
+                double *out = realOut + c * totalSize;
+
+                for (int i = 0; i < effectiveSize; ++i)
+                    out[i] = data[((tail + i) & mask) * channels + c] - m;
+            }
+        }
+    }
+
+    void FFTBuffer::drop(int n)
+    {
+        uint64_t tail = head - count;
+
+        for (int i = 0; i < n; ++i) {
+            const double *slot = &data[((tail + i) & mask) * channels];
+
+            for (int c = 0; c < channels; ++c)
+                sum[c] -= slot[c];
+        }
+
+        count -= n;
+
+        // Avoid accumulating rounding errors over long runs.
+        if (count == 0)
+            std::fill(sum.begin(), sum.end(), 0.0);
+    }
+
+    void FFTBuffer::zeroPad()
+    {
+        for (int c = 0; c < channels; ++c) {
+            if (complex) {
+                fftw_complex *out = dataOut + c * totalSize;
+
+                for (int i = effectiveSize; i < totalSize; ++i) {
+                    out[i][0] = 0.0;
+                    out[i][1] = 0.0;
+                }
+            } else {
+                double *out = realOut + c * totalSize;
+                std::fill(out + effectiveSize, out + totalSize, 0.0);
+            }
+        }
+    }
+
+    void FFTBuffer::update(int i, double value, int channel)
+    {
+        if (i >= totalSize || i < 0 || channel < 0 || channel >= channels)
+            return;
+
+        if (complex)
+            dataOut[channel * totalSize + i][0] = value;
+        else
+            realOut[channel * totalSize + i] = value;
+    }
+
+    double FFTBuffer::getValue(int i, int channel)
+    {
+        if (i >= totalSize || i < 0 || channel < 0 || channel >= channels)
+            return 0.0;
+
+        if (complex)
+            return dataOut[channel * totalSize + i][0];
+        return realOut[channel * totalSize + i];
+    }
+
+    void FFTBuffer::applyWindow(const std::vector<double> &coefficients)
+    {
+        int n = std::min((int) coefficients.size(), effectiveSize);
+        const double *w = coefficients.data();
+
+        for (int c = 0; c < channels; ++c) {
+            if (complex) {
+                fftw_complex *out = dataOut + c * totalSize;
+
+                for (int i = 0; i < n; ++i)
+                    out[i][0] *= w[i];
+            } else {
+                double *__restrict out = realOut + c * totalSize;
+
+                for (int i = 0; i < n; ++i)
+                    out[i] *= w[i];
+            }
+        }
+    }
+
+    void FFTBuffer::allocate()
+    {
+        fftw_free(dataOut);
+        fftw_free(realOut);
+        dataOut = nullptr;
+        realOut = nullptr;
+
+        if (complex)
+            dataOut = fftw_alloc_complex(totalSize * channels);
+        else
+            realOut = fftw_alloc_real(totalSize * channels);
+    }
+
+    void FFTBuffer::setSize(int effective, int zeroPad, int window)
+    {
+        if (window <= 0)
+            window = effective;
+
+        effectiveSize = effective;
+        zeroPadSize = zeroPad;
+        totalSize = effective + zeroPad;
+        windowSize = window;
+
+        uint64_t capacity = 1;
+        while (capacity < (uint64_t) effectiveSize)
+            capacity <<= 1;
+
+        data.assign(capacity * channels, 0.0);
+        mask = capacity - 1;
+        head = 0;
+        count = 0;
+        sum.assign(channels, 0.0);
+        mean.assign(channels, 0.0);
+
+        allocate();
+    }
+
+    void FFTBuffer::setChannels(int channels)
+    {
+        this->channels = std::max(1, channels);
+        setSize(effectiveSize, zeroPadSize, windowSize);
+    }
+
+    int FFTBuffer::getChannels()
+    {
+        return channels;
+    }
+
+    void FFTBuffer::setComplex(bool status)
+    {
+        complex = status;
+        setSize(effectiveSize, zeroPadSize, windowSize);
+    }
+
+    bool FFTBuffer::isComplex()
+    {
+        return complex;
+    }
+
+    fftw_complex *FFTBuffer::get(int channel)
+    {
+        if (!dataOut)
+            return nullptr;
+        return dataOut + channel * totalSize;
+    }
+
+    double *FFTBuffer::getReal(int channel)
+    {
+        if (!realOut)
+            return nullptr;
+        return realOut + channel * totalSize;
+    }
+
+    unsigned int FFTBuffer::getSize()
+    {
+        return effectiveSize;
+    }
+
+    unsigned int FFTBuffer::getTotalSize()
+    {
+        return totalSize;
+    }
+
+    int FFTBuffer::getWindowSize()
+    {
+        return windowSize;
+    }
+
+    int FFTBuffer::getZeroPadSize()
+    {
+        return zeroPadSize;
+    }
+
+    double FFTBuffer::getMean(int channel)
+    {
+        return mean[channel];
+    }
+
+}
@@ -0,0 +1,190 @@
+/**
+ * This class is a wrapper for the fftw input array.
+ *
+ * It allows adding of data like a queue and fills either a real (double)
+ * buffer for the r2c transform or a fftw_complex buffer for the complex
+ * transform. If required, it can be configured to do zero padding.
+ * Additionally, a sliding window is used. It determines the number of
+ * new samples required to return a new buffer.
+ *
+ * The samples are held in a fixed-capacity ring buffer (power of 2),
+ * so adding a sample is O(1) and building a frame is a single linear
+ * copy out of the ring.
+ *
+ * Several channels can be buffered in lockstep (one sample per channel
+ * per add()). The ring interleaves the channels, the output arrays
+ * hold the frames one after another (channel c starts at
+ * c * getTotalSize()), which is the layout of a batched FFTW plan.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef FFT_BUFFER_H
+#define FFT_BUFFER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <fftw3.h>
+
+// Default sizes (in samples)
+#define DEFAULT_SIZE 128
+#define DEFAULT_WINDOW_SIZE 64
+#define DEFAULT_ZERO_PAD_SIZE (4*DEFAULT_SIZE)
+
+namespace hrm
+{
+
+    class FFTBuffer
+    {
+        private:
+            int effectiveSize;
+            int zeroPadSize;
+            int totalSize;
+            int windowSize;
+            int channels = 1;
+
+            // Only one of them is allocated (see setComplex()).
+            fftw_complex *dataOut = nullptr;
+            double *realOut = nullptr;
+            bool complex = false;
+
+            // Ring buffer, capacity is a power of 2 >= effectiveSize
+            // (times the channels, interleaved).
+            std::vector<double> data;
+            uint64_t mask = 0;
+            uint64_t head = 0; // Total number of written samples
+            int count = 0; // Number of samples currently held
+
+            // Running sum of the held samples per channel (for the mean).
+            std::vector<double> sum;
+            // Mean removed from the last output array per channel
+            std::vector<double> mean;
+
+            /**
+             * Frees and allocates the output array for the current sizes.
+             */
+            void allocate();
+
+            /**
+             * Copy data from the ring buffer to the output array and preserve
+             * (effectiveSize - windowSize) elements in the ring.
+             */
+            void copyToDataOut();
+
+            /**
+             * Zero pad the last zeroPadSize elements in the output array.
+             */
+            void zeroPad();
+
+            /**
+             * Removes the n oldest elements from the ring buffer.
+             */
+            void drop(int n);
+
+        public:
+            /**
+             * If (effectiveSize <= windowSize) => All data is
+             * removed from the buffer. Each output array has "fresh" data.
+             *
+             * If (effectiveSize > windowSize && windowSize > 0) =>
+             * (effectiveSize - windowSize) elements are preserved in
+             * the buffer. windowSize new elements are needed
+             * that add() returns true again.
+             */
+            FFTBuffer(int effective = DEFAULT_SIZE,
+                      int zeroPad = DEFAULT_ZERO_PAD_SIZE,
+                      int window = DEFAULT_WINDOW_SIZE);
+            ~FFTBuffer();
+
+            /**
+             * Adds the data as real value to the buffer. If this returns
+             * true, the output array consists of valid data. It is zero
+             * padded and normalized with its mean.
+             *
+             * @retval false Added value, but buffer is not full.
+             * @retval true The output array is full.
+             */
+            bool add(double p_data);
+
+            /**
+             * Adds one sample per channel (see add(double)).
+             */
+            bool add(const double *samples);
+
+            /**
+             * Update the (real) value with index i in the output array.
+             */
+            void update(int i, double value, int channel = 0);
+
+            /**
+             * Get a (real) value from the output array.
+             */
+            double getValue(int i, int channel = 0);
+
+            /**
+             * Multiplies the first effectiveSize (real) values of the
+             * output array of each channel with the given coefficients.
+             */
+            void applyWindow(const std::vector<double> &coefficients);
+
+            /**
+             * Selects the output array type. A complex array is only
+             * required for the complex (c2c) transform. Clears the internal
+             * data.
+             */
+            void setComplex(bool status);
+
+            bool isComplex();
+
+            /**
+             * clears the internal data and sets a new size.
+             */
+            void setSize(int effective, int zeroPad, int window);
+
+            /**
+             * Clears the internal data.
+             */
+            void setChannels(int channels);
+
+            int getChannels();
+
+            /**
+             * @return The complex output array (of the channel), nullptr
+             * in real mode.
+             */
+            fftw_complex *get(int channel = 0);
+
+            /**
+             * @return The real output array (of the channel), nullptr in
+             * complex mode.
+             */
+            double *getReal(int channel = 0);
+
+            /**
+             * @return The mean removed from the last output array of the
+             * channel (DC level).
+             */
+            double getMean(int channel = 0);
+
+            /**
+             * @return effective size
+             */
+            unsigned int getSize();
+
+            /**
+             * @return effective + zeroPad size
+             */
+            unsigned int getTotalSize();
+
+            /**
+             * @return The sliding window size
+             */
+            int getWindowSize();
+
+            int getZeroPadSize();
+    };
+
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include "FFTPlanCache.h"
+
+#include "Trace.h"
+
+#include <cstdlib>
+
+namespace hrm
+{
+
+    Plan::~Plan()
+    {
+        std::lock_guard<std::mutex> lock(FFTPlanCache::plannerMutex());
+
+        if (estimate != nullptr)
+            fftw_destroy_plan(estimate);
+
+        fftw_plan plan = measured.load();
+        if (plan != nullptr)
+            fftw_destroy_plan(plan);
+    }
+
+    FFTPlanCache::FFTPlanCache()
+    {
+        // Construct the planner mutex first, so it outlives the cache.
+        plannerMutex();
+
+        worker = std::thread(&FFTPlanCache::run, this);
+    }
+
+    FFTPlanCache &FFTPlanCache::instance()
+    {
+        static FFTPlanCache cache;
+        return cache;
+    }
+
+    std::mutex &FFTPlanCache::plannerMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    FFTPlanCache::~FFTPlanCache()
+    {
+        stop();
+        clear();
+    }
+
+    std::shared_ptr<Plan> FFTPlanCache::getR2C(int n, double *in, fftw_complex *out,
+            int howmany, bool deterministic)
+    {
+        return get({n, FFTW_FORWARD, R2C, isAligned(in, out), howmany, deterministic});
+    }
+
+    std::shared_ptr<Plan> FFTPlanCache::getC2R(int n, fftw_complex *in, double *out,
+            int howmany, bool deterministic)
+    {
+        return get({n, FFTW_BACKWARD, R2C, isAligned(in, out), howmany, deterministic});
+    }
+
+    std::shared_ptr<Plan> FFTPlanCache::getC2C(int n, fftw_complex *in, fftw_complex *out,
+            int direction, int howmany, bool deterministic)
+    {
+        return get({n, direction, C2C, isAligned(in, out), howmany, deterministic});
+    }
+
+    std::shared_ptr<Plan> FFTPlanCache::get(const PlanKey &key)
+    {
+        unsigned int planFlags;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = plans.find(key);
+            if (it != plans.end())
+                return it->second;
+
+            planFlags = flags;
+        }
+
+        // Planned without the cache mutex, lookups go on meanwhile. A
+        // running measurement only holds the planner mutex for one
+        // slice (see run()).
+        auto plan = std::make_shared<Plan>();
+        {
+            std::lock_guard<std::mutex> plannerLock(plannerMutex());
+
+            if (key.deterministic) {
+                plan->estimate = createDeterministic(key);
+            } else {
+                // Known by the wisdom => no measuring required.
+                fftw_plan known = create(key, planFlags | FFTW_WISDOM_ONLY);
+
+                if (known != nullptr)
+                    plan->measured.store(known, std::memory_order_release);
+                else
+                    plan->estimate = create(key, FFTW_ESTIMATE);
+            }
+        }
+
+        // Declared after the plan, so an unused plan is destroyed (which
+        // locks the planner mutex) after the cache mutex is released.
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Another thread may have created it meanwhile.
+        auto it = plans.find(key);
+        if (it != plans.end())
+            return it->second;
+
+        if (!plan->isMeasured() && !key.deterministic && !stopped) {
+            queue.push_back(std::make_pair(key, plan));
+            queueChanged.notify_all();
+        }
+
+        plans[key] = plan;
+
+        return plan;
+    }
+
+    fftw_plan FFTPlanCache::measure(const PlanKey &key, unsigned int flags)
+    {
+        for (int slice = 1; ; ++slice) {
+            std::lock_guard<std::mutex> plannerLock(plannerMutex());
+
+            fftw_set_timelimit(FFT_PLAN_SLICE);
+            fftw_plan plan = create(key, flags);
+            fftw_set_timelimit(FFTW_NO_TIMELIMIT);
+
+            // Solved sub-problems are kept in the wisdom, so every slice
+            // gets further. The plan itself is in the wisdom once a
+            // slice finished in time.
+            fftw_plan complete = create(key, flags | FFTW_WISDOM_ONLY);
+
+            if (complete != nullptr) {
+                fftw_destroy_plan(plan);
+                return complete;
+            }
+
+            if (slice == FFT_PLAN_MAX_SLICES)
+                return plan;
+
+            fftw_destroy_plan(plan);
+        }
+    }
+
+    fftw_plan FFTPlanCache::createDeterministic(const PlanKey &key)
+    {
+        char *wisdom = fftw_export_wisdom_to_string();
+        fftw_forget_wisdom();
+
+        fftw_plan plan = create(key, FFTW_ESTIMATE);
+
+        // Without what this plan added.
+        fftw_forget_wisdom();
+        if (wisdom != nullptr) {
+            fftw_import_wisdom_from_string(wisdom);
+            free(wisdom);
+        }
+
+        return plan;
+    }
+
+    void FFTPlanCache::run()
+    {
+        Trace::instance().setThreadName("FFT planner");
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            queueChanged.wait(lock, [this] { return stopped || !queue.empty(); });
+
+            if (stopped)
+                break;
+
+            PlanKey key = queue.front().first;
+            std::shared_ptr<Plan> plan = queue.front().second;
+            unsigned int planFlags = flags;
+
+            // Planning takes long, allow new requests meanwhile.
+            lock.unlock();
+
+            plan->measured.store(measure(key, planFlags), std::memory_order_release);
+            // May be the last reference (cleared cache), destroy it
+            // without the cache mutex.
+            plan.reset();
+
+            lock.lock();
+            // stop() may have cleared the queue meanwhile.
+            if (!queue.empty())
+                queue.pop_front();
+            queueChanged.notify_all();
+        }
+    }
+
+    fftw_plan FFTPlanCache::create(const PlanKey &key, unsigned int flags)
+    {
+        unsigned int planFlags = flags | FFTW_PRESERVE_INPUT;
+        if (!key.aligned)
+            planFlags |= FFTW_UNALIGNED;
+
+        fftw_plan plan;
+        int n = key.size;
+        int half = n / 2 + 1;
+
+        if (key.type == C2C) {
+            fftw_complex *in = fftw_alloc_complex(n * key.howmany);
+            fftw_complex *out = fftw_alloc_complex(n * key.howmany);
+
+            if (key.howmany == 1)
+                plan = fftw_plan_dft_1d(n, in, out, key.direction, planFlags);
+            else
+                plan = fftw_plan_many_dft(1, &n, key.howmany, in, nullptr, 1, n,
+                                          out, nullptr, 1, n, key.direction, planFlags);
+
+            fftw_free(in);
+            fftw_free(out);
+        } else {
+            double *real = fftw_alloc_real(n * key.howmany);
+            fftw_complex *complex = fftw_alloc_complex(half * key.howmany);
+
+            if (key.howmany == 1) {
+                if (key.direction == FFTW_FORWARD)
+                    plan = fftw_plan_dft_r2c_1d(n, real, complex, planFlags);
+                else
+                    plan = fftw_plan_dft_c2r_1d(n, complex, real, planFlags);
+            } else {
+                if (key.direction == FFTW_FORWARD)
+                    plan = fftw_plan_many_dft_r2c(1, &n, key.howmany, real, nullptr, 1, n,
+                                                  complex, nullptr, 1, half, planFlags);
+                else
+                    plan = fftw_plan_many_dft_c2r(1, &n, key.howmany, complex, nullptr, 1, half,
+                                                  real, nullptr, 1, n, planFlags);
+            }
+
+            fftw_free(real);
+            fftw_free(complex);
+        }
+
+        return plan;
+    }
+
+    bool FFTPlanCache::isAligned(void *in, void *out)
+    {
+        return fftw_alignment_of((double *) in) == 0 &&
+               fftw_alignment_of((double *) out) == 0;
+    }
+
+    void FFTPlanCache::setFlags(unsigned int flags)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->flags = flags;
+    }
+
+    void FFTPlanCache::waitForPlans()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        queueChanged.wait(lock, [this] { return stopped || queue.empty(); });
+    }
+
+    void FFTPlanCache::stop()
+    {
+        std::deque<std::pair<PlanKey, std::shared_ptr<Plan>>> removed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+            removed.swap(queue);
+            queueChanged.notify_all();
+        }
+
+        if (worker.joinable())
+            worker.join();
+    }
+
+    bool FFTPlanCache::loadWisdom(const std::string &fileName)
+    {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        return fftw_import_wisdom_from_filename(fileName.c_str()) != 0;
+    }
+
+    bool FFTPlanCache::saveWisdom(const std::string &fileName)
+    {
+        std::lock_guard<std::mutex> lock(plannerMutex());
+        return fftw_export_wisdom_to_filename(fileName.c_str()) != 0;
+    }
+
+    void FFTPlanCache::clear()
+    {
+        std::map<PlanKey, std::shared_ptr<Plan>> removed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            removed.swap(plans);
+        }
+        // Destroyed here, without the cache mutex.
+    }
+
+    int FFTPlanCache::size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return plans.size();
+    }
+
+}
@@ -0,0 +1,218 @@
+/**
+ * Process wide cache for FFTW plans.
+ *
+ * Plans are keyed by (size, direction, type, alignment, batch) and
+ * owned by the cache. They are executed with the new-array execute functions
+ * (fftw_execute_dft, fftw_execute_dft_r2c, ...), so they can be used
+ * with any array that has the same alignment.
+ *
+ * A new configuration gets a FFTW_ESTIMATE plan immediately (or the
+ * final plan, if FFTW wisdom already knows it). The measured plan is
+ * built on a background thread and swapped in atomically, so callers
+ * that fetch Plan::get() once per frame switch between two frames.
+ *
+ * The background planner measures in slices of FFT_PLAN_SLICE, so a
+ * new request waits at most one slice for the planner. The cache mutex
+ * is never held while planning or destroying plans, cached lookups do
+ * not wait for the planner.
+ *
+ * FFTW wisdom can be loaded and saved, so a cold start does not need
+ * to measure again.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef FFT_PLAN_CACHE_H
+#define FFT_PLAN_CACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <fftw3.h>
+
+// Longest time the background planner holds the planner mutex at once.
+#define FFT_PLAN_SLICE 0.05 // s
+// Afterwards, the best plan found so far is used.
+#define FFT_PLAN_MAX_SLICES 200
+
+namespace hrm
+{
+
+    /**
+     * R2C: Real input, only the N/2+1 half-spectrum is calculated (default).
+     * C2C: Complex DFT on the real data (imaginary part is zero).
+     */
+    enum FFT_TYPE {R2C, C2C};
+
+    struct PlanKey {
+        int size;
+        int direction; // FFTW_FORWARD or FFTW_BACKWARD (R2C: c2r)
+        FFT_TYPE type;
+        bool aligned; // Both arrays are SIMD aligned
+        // Transforms per execution (batched plan). The arrays hold
+        // them one after another.
+        int howmany;
+        // Only FFTW_ESTIMATE, planned without wisdom
+        bool deterministic;
+
+        bool operator<(const PlanKey &other) const {
+            if (deterministic != other.deterministic)
+                return deterministic < other.deterministic;
+            if (howmany != other.howmany)
+                return howmany < other.howmany;
+            if (size != other.size)
+                return size < other.size;
+            if (direction != other.direction)
+                return direction < other.direction;
+            if (type != other.type)
+                return type < other.type;
+            return aligned < other.aligned;
+        }
+    };
+
+    class Plan
+    {
+            friend class FFTPlanCache;
+
+        private:
+            fftw_plan estimate = nullptr;
+            std::atomic<fftw_plan> measured;
+
+        public:
+            Plan() : measured(nullptr) {}
+            ~Plan();
+
+            Plan(const Plan &) = delete;
+            Plan &operator=(const Plan &) = delete;
+
+            /**
+             * @return The measured plan if it is ready, otherwise the
+             * estimated plan. Fetch it once per frame.
+             */
+            fftw_plan get() const {
+                fftw_plan plan = measured.load(std::memory_order_acquire);
+                return plan != nullptr ? plan : estimate;
+            }
+
+            bool isMeasured() const {
+                return measured.load(std::memory_order_acquire) != nullptr;
+            }
+    };
+
+    class FFTPlanCache
+    {
+        private:
+            std::map<PlanKey, std::shared_ptr<Plan>> plans;
+            std::mutex mutex;
+
+            // Background planner
+            std::thread worker;
+            std::deque<std::pair<PlanKey, std::shared_ptr<Plan>>> queue;
+            std::condition_variable queueChanged;
+            bool stopped = false;
+
+            unsigned int flags = FFTW_MEASURE;
+
+            FFTPlanCache();
+
+            /**
+             * Creates a plan for the key on scratch arrays (planning
+             * with FFTW_MEASURE overwrites the arrays). Must be called
+             * with the planner mutex locked.
+             *
+             * @retval nullptr Only possible with FFTW_WISDOM_ONLY.
+             */
+            static fftw_plan create(const PlanKey &key, unsigned int flags);
+
+            /**
+             * Plans with the flags in slices of FFT_PLAN_SLICE, the
+             * planner mutex is released in between.
+             */
+            static fftw_plan measure(const PlanKey &key, unsigned int flags);
+
+            /**
+             * FFTW_ESTIMATE also uses the wisdom of more patient plans,
+             * so the wisdom is put aside meanwhile. Must be called with
+             * the planner mutex locked.
+             */
+            static fftw_plan createDeterministic(const PlanKey &key);
+
+            std::shared_ptr<Plan> get(const PlanKey &key);
+
+            void run();
+
+            static bool isAligned(void *in, void *out);
+
+        public:
+            ~FFTPlanCache();
+
+            FFTPlanCache(const FFTPlanCache &) = delete;
+            FFTPlanCache &operator=(const FFTPlanCache &) = delete;
+
+            static FFTPlanCache &instance();
+
+            /**
+             * The FFTW planner (and fftw_destroy_plan) is not thread safe,
+             * every call into it has to hold this mutex.
+             */
+            static std::mutex &plannerMutex();
+
+            /**
+             * The arrays are only used to determine the alignment, they
+             * are not touched.
+             *
+             * @param howmany Number of transforms of one execution. Real
+             * arrays hold them at a distance of n, complex arrays at a
+             * distance of n/2+1 (R2C/C2R) or n (C2C).
+             * @param deterministic Only a FFTW_ESTIMATE plan, planned
+             * without the wisdom and never measured: The plan (and so the
+             * rounding of the results) does not depend on timing or on
+             * earlier runs. Used for bit-identical replays. Cached apart
+             * from the other plans.
+             */
+            std::shared_ptr<Plan> getR2C(int n, double *in, fftw_complex *out,
+                                         int howmany = 1, bool deterministic = false);
+            std::shared_ptr<Plan> getC2R(int n, fftw_complex *in, double *out,
+                                         int howmany = 1, bool deterministic = false);
+            std::shared_ptr<Plan> getC2C(int n, fftw_complex *in, fftw_complex *out,
+                                         int direction = FFTW_FORWARD, int howmany = 1,
+                                         bool deterministic = false);
+
+            /**
+             * Planner flags used for the background plans (FFTW_MEASURE
+             * or FFTW_PATIENT, default FFTW_MEASURE).
+             */
+            void setFlags(unsigned int flags);
+
+            /**
+             * Blocks until all queued plans are measured.
+             */
+            void waitForPlans();
+
+            /**
+             * Stops the background planner. Pending plans keep their
+             * estimated version.
+             */
+            void stop();
+
+            bool loadWisdom(const std::string &fileName);
+            bool saveWisdom(const std::string &fileName);
+
+            /**
+             * Removes all plans from the cache. Plans still in use are
+             * destroyed when their last user releases them.
+             */
+            void clear();
+
+            int size();
+    };
+
+}
+
+#endif
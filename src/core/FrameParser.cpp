@@ -0,0 +1,201 @@
+#include "FrameParser.h"
+
+namespace hrm
+{
+
+    static inline uint16_t readUInt16(const uint8_t *data)
+    {
+        return data[0] | (data[1] << 8);
+    }
+
+    static inline void writeUInt16(uint8_t *data, uint16_t value)
+    {
+        data[0] = value & 0xFF;
+        data[1] = value >> 8;
+    }
+
+    FrameParser::FrameParser(SamplesCallback samplesCallback,
+                             LineCallback lineCallback) :
+        samplesCallback(samplesCallback),
+        lineCallback(lineCallback)
+    {
+    }
+
+    size_t FrameParser::parse(const char *data, size_t size)
+    {
+        const uint8_t *bytes = (const uint8_t *) data;
+        size_t pos = 0;
+
+        while (pos < size) {
+            if (bytes[pos] == FRAME_SYNC_0) {
+                long consumed = parseFrame(bytes + pos, size - pos);
+
+                if (consumed == 0)
+                    break; // Incomplete
+
+                if (consumed < 0) {
+                    // Resync
+                    ++statistics.skippedBytes;
+                    ++pos;
+                } else {
+                    pos += consumed;
+                }
+
+                continue;
+            }
+
+            // Text line (ends with '\n', interrupted by a sync byte)
+            size_t end = pos;
+            while (end < size && bytes[end] != '\n' && bytes[end] != FRAME_SYNC_0)
+                ++end;
+
+            if (end == size) {
+                // Incomplete, unless it is too long to be a line.
+                if (size - pos > FRAME_MAX_LINE) {
+                    statistics.skippedBytes += size - pos;
+                    pos = size;
+                }
+                break;
+            }
+
+            if (bytes[end] == '\n') {
+                if (lineCallback)
+                    lineCallback(data + pos, end - pos);
+                pos = end + 1;
+            } else {
+                statistics.skippedBytes += end - pos;
+                pos = end;
+            }
+        }
+
+        return pos;
+    }
+
+    long FrameParser::parseFrame(const uint8_t *data, size_t size)
+    {
+        if (size < 2)
+            return 0;
+        if (data[1] != FRAME_SYNC_1)
+            return -1;
+        if (size < FRAME_HEADER_SIZE)
+            return 0;
+
+        uint16_t length = readUInt16(data + 2);
+
+        if (length < 2 || length > FRAME_MAX_PAYLOAD || (length - 2) % 4 != 0)
+            return -1;
+
+        size_t frameSize = FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE;
+        if (size < frameSize)
+            return 0;
+
+        const uint8_t *payload = data + FRAME_HEADER_SIZE;
+
+        if (crc16(data + 2, 2 + length) != readUInt16(payload + length)) {
+            ++statistics.crcErrors;
+            return -1;
+        }
+
+        uint16_t sequence = readUInt16(payload);
+        int count = (length - 2) / 4;
+
+        if (hasSequence) {
+            uint16_t ahead = sequence - lastSequence;
+            uint16_t behind = lastSequence - sequence;
+
+            // Its samples were already delivered.
+            if (behind < FRAME_DUPLICATE_WINDOW) {
+                ++statistics.duplicateFrames;
+                return frameSize;
+            }
+
+            // Otherwise a restarted counter, no gap.
+            if (ahead <= FRAME_MAX_GAP)
+                statistics.lostFrames += ahead - 1;
+        }
+        hasSequence = true;
+        lastSequence = sequence;
+
+        SensorData samples[FRAME_MAX_SAMPLES];
+        const uint8_t *p = payload + 2;
+
+        for (int i = 0; i < count; ++i, p += 4) {
+            samples[i].broadband = readUInt16(p);
+            samples[i].ir = readUInt16(p + 2);
+        }
+
+        ++statistics.frames;
+        statistics.samples += count;
+
+        if (samplesCallback)
+            samplesCallback(samples, count, sequence);
+
+        return frameSize;
+    }
+
+    void FrameParser::setSamplesCallback(SamplesCallback callback)
+    {
+        samplesCallback = callback;
+    }
+
+    void FrameParser::setLineCallback(LineCallback callback)
+    {
+        lineCallback = callback;
+    }
+
+    const FrameStatistics &FrameParser::getStatistics()
+    {
+        return statistics;
+    }
+
+    void FrameParser::reset()
+    {
+        hasSequence = false;
+    }
+
+    uint16_t FrameParser::crc16(const uint8_t *data, size_t size)
+    {
+        // CRC16-CCITT (polynomial 0x1021, init 0xFFFF)
+        struct Table {
+            uint16_t values[256];
+
+            Table() {
+                for (int i = 0; i < 256; ++i) {
+                    uint16_t crc = i << 8;
+                    for (int bit = 0; bit < 8; ++bit)
+                        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+                    values[i] = crc;
+                }
+            }
+        };
+        static const Table table;
+
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < size; ++i)
+            crc = (crc << 8) ^ table.values[((crc >> 8) ^ data[i]) & 0xFF];
+
+        return crc;
+    }
+
+    size_t FrameParser::encode(const SensorData *data, int count,
+                               uint16_t sequence, uint8_t *out)
+    {
+        uint16_t length = 2 + 4 * count;
+
+        out[0] = FRAME_SYNC_0;
+        out[1] = FRAME_SYNC_1;
+        writeUInt16(out + 2, length);
+        writeUInt16(out + 4, sequence);
+
+        uint8_t *p = out + 6;
+        for (int i = 0; i < count; ++i, p += 4) {
+            writeUInt16(p, data[i].broadband);
+            writeUInt16(p + 2, data[i].ir);
+        }
+
+        writeUInt16(p, crc16(out + 2, 2 + length));
+
+        return FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE;
+    }
+
+}
@@ -0,0 +1,116 @@
+/**
+ * Parser for the binary framing mode of the light sensor.
+ *
+ * Frame layout (little endian):
+ *
+ *   0xA5 0x5A             sync
+ *   uint16 length         bytes of the payload
+ *   uint16 sequence       payload: frame counter
+ *   N * (uint16 broadband, uint16 ir)
+ *   uint16 crc            CRC16-CCITT over length and payload
+ *
+ * Answers to commands (settings) are still sent as text lines, so the
+ * parser accepts both in one stream. A text line never contains the
+ * sync byte. After a corrupted frame, the parser skips one byte and
+ * searches for the next sync (bytes in between are treated as text and
+ * usually dropped as malformed lines).
+ *
+ * The parser works on the receive buffer in place, nothing is copied.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef FRAME_PARSER_H
+#define FRAME_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional>
+
+#include "SensorProtocol.h"
+
+#define FRAME_SYNC_0 0xA5
+#define FRAME_SYNC_1 0x5A
+#define FRAME_HEADER_SIZE 4 // sync + length
+#define FRAME_CRC_SIZE 2
+#define FRAME_MAX_SAMPLES 256
+#define FRAME_MAX_PAYLOAD (2 + 4 * FRAME_MAX_SAMPLES)
+#define FRAME_MAX_LINE 256
+// Frames up to this far behind the last one are repeated (e.g. resent),
+// further back the sensor restarted its counter.
+#define FRAME_DUPLICATE_WINDOW 16
+// Larger jumps ahead are a restarted counter as well, not lost frames.
+#define FRAME_MAX_GAP 1024
+
+namespace hrm
+{
+
+    struct FrameStatistics {
+        uint64_t frames = 0;
+        uint64_t samples = 0;
+        uint64_t crcErrors = 0;
+        uint64_t lostFrames = 0; // Gaps in the sequence numbers
+        uint64_t duplicateFrames = 0; // Dropped, see FRAME_DUPLICATE_WINDOW
+        uint64_t skippedBytes = 0;
+    };
+
+    class FrameParser
+    {
+        public:
+            typedef std::function<void(const SensorData *data, int count,
+                                       uint16_t sequence)> SamplesCallback;
+            typedef std::function<void(const char *line, size_t length)> LineCallback;
+
+        private:
+            SamplesCallback samplesCallback;
+            LineCallback lineCallback;
+
+            FrameStatistics statistics;
+            bool hasSequence = false;
+            uint16_t lastSequence = 0;
+
+            /**
+             * @return Number of bytes consumed, 0 if more data is
+             * required, -1 if the frame is invalid.
+             */
+            long parseFrame(const uint8_t *data, size_t size);
+
+        public:
+            FrameParser(SamplesCallback samplesCallback = nullptr,
+                        LineCallback lineCallback = nullptr);
+
+            /**
+             * Parses as many complete frames and lines as possible.
+             *
+             * @return Number of consumed bytes. The remaining bytes are an
+             * incomplete frame or line and must be passed again (with
+             * the following data).
+             */
+            size_t parse(const char *data, size_t size);
+
+            void setSamplesCallback(SamplesCallback callback);
+            void setLineCallback(LineCallback callback);
+
+            const FrameStatistics &getStatistics();
+
+            /**
+             * Forget the last sequence number (e.g. after reconnect).
+             */
+            void reset();
+
+            static uint16_t crc16(const uint8_t *data, size_t size);
+
+            /**
+             * Builds a frame (for tests and the simulator).
+             *
+             * @param out At least FRAME_HEADER_SIZE + 2 + 4 * count + FRAME_CRC_SIZE bytes.
+             * @return Size of the frame.
+             */
+            static size_t encode(const SensorData *data, int count,
+                                 uint16_t sequence, uint8_t *out);
+    };
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "LineParser.h"
+
+#include <cstring>
+
+namespace hrm
+{
+
+    size_t LineParser::parse(const char *data, size_t size)
+    {
+        size_t pos = 0;
+
+        while (pos < size) {
+            const char *newline = (const char *) memchr(data + pos, '\n', size - pos);
+
+            if (newline == nullptr) {
+                // Incomplete, unless it is too long to be a line.
+                if (size - pos > LINE_MAX_LENGTH) {
+                    statistics.discardedBytes += size - pos;
+                    ++statistics.malformedLines;
+                    pos = size;
+                }
+                break;
+            }
+
+            size_t length = newline - (data + pos);
+            parseLine(data + pos, length);
+
+            pos += length + 1;
+        }
+
+        return pos;
+    }
+
+    LINE_TYPE LineParser::parseLine(const char *line, size_t length)
+    {
+        SensorData data;
+        SensorSettings settings;
+
+        ++statistics.lines;
+
+        // Ignore empty lines
+        size_t i = 0;
+        while (i < length && (line[i] == ' ' || line[i] == '\r' || line[i] == '\t'))
+            ++i;
+        if (i == length)
+            return LINE_INVALID;
+
+        LINE_TYPE type = SensorProtocol::parseLine(line, line + length, data, settings);
+
+        switch (type) {
+        case LINE_DATA:
+            ++statistics.dataLines;
+            if (dataCallback)
+                dataCallback(data);
+            return type;
+        case LINE_SETTINGS:
+            ++statistics.settingsLines;
+            if (settingsCallback)
+                settingsCallback(settings);
+            break;
+        case LINE_INVALID:
+            ++statistics.malformedLines;
+            break;
+        }
+
+        if (lineCallback)
+            lineCallback(line, length);
+
+        return type;
+    }
+
+    void LineParser::setDataCallback(DataCallback callback)
+    {
+        dataCallback = callback;
+    }
+
+    void LineParser::setSettingsCallback(SettingsCallback callback)
+    {
+        settingsCallback = callback;
+    }
+
+    void LineParser::setLineCallback(LineCallback callback)
+    {
+        lineCallback = callback;
+    }
+
+    const LineStatistics &LineParser::getStatistics()
+    {
+        return statistics;
+    }
+
+}
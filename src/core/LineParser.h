@@ -0,0 +1,70 @@
+/**
+ * Streaming parser for the text protocol of the light sensor.
+ *
+ * It consumes every complete line of a receive buffer per call (drain
+ * all) and parses them in place, so data lines do not allocate. The
+ * remaining bytes are an incomplete line that has to be passed again
+ * with the next data.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef LINE_PARSER_H
+#define LINE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional>
+
+#include "SensorProtocol.h"
+
+#define LINE_MAX_LENGTH 256
+
+namespace hrm
+{
+
+    struct LineStatistics {
+        uint64_t lines = 0;
+        uint64_t dataLines = 0;
+        uint64_t settingsLines = 0;
+        uint64_t malformedLines = 0;
+        uint64_t discardedBytes = 0; // Too long lines
+    };
+
+    class LineParser
+    {
+        public:
+            typedef std::function<void(const SensorData &data)> DataCallback;
+            typedef std::function<void(const SensorSettings &settings)> SettingsCallback;
+            // All lines except data lines (settings, answers, malformed)
+            typedef std::function<void(const char *line, size_t length)> LineCallback;
+
+        private:
+            DataCallback dataCallback;
+            SettingsCallback settingsCallback;
+            LineCallback lineCallback;
+
+            LineStatistics statistics;
+
+        public:
+            /**
+             * @return Number of consumed bytes.
+             */
+            size_t parse(const char *data, size_t size);
+
+            /**
+             * Parses one line without line break.
+             */
+            LINE_TYPE parseLine(const char *line, size_t length);
+
+            void setDataCallback(DataCallback callback);
+            void setSettingsCallback(SettingsCallback callback);
+            void setLineCallback(LineCallback callback);
+
+            const LineStatistics &getStatistics();
+    };
+
+}
+
+#endif
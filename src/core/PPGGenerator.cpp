@@ -0,0 +1,103 @@
+#include "PPGGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+const static double M_PI = 3.14159265359;
+#endif
+
+#define MOTION_MIN_DURATION 0.5 // s
+#define MOTION_MAX_DURATION 2.0
+#define MOTION_MIN_FREQUENCY 0.2 // Hz
+#define MOTION_MAX_FREQUENCY 3.0
+
+namespace hrm
+{
+
+    PPGGenerator::PPGGenerator(const PPGSettings &settings) :
+        settings(settings),
+        random(settings.seed),
+        gaussian(0.0, 1.0),
+        uniform(0.0, 1.0)
+    {
+    }
+
+    void PPGGenerator::updateMotion(double interval)
+    {
+        if (time < motionEnd || settings.motionRate <= 0.0)
+            return;
+
+        motionAmplitude = 0.0;
+
+        // Poisson process: probability of an artifact in this interval
+        double probability = settings.motionRate / 60.0 * interval;
+        if (uniform(random) >= probability)
+            return;
+
+        double duration = MOTION_MIN_DURATION +
+                          uniform(random) * (MOTION_MAX_DURATION - MOTION_MIN_DURATION);
+
+        motionEnd = time + duration;
+        motionFrequency = MOTION_MIN_FREQUENCY +
+                          uniform(random) * (MOTION_MAX_FREQUENCY - MOTION_MIN_FREQUENCY);
+        motionAmplitude = settings.motionAmplitude * (0.5 + uniform(random));
+        if (uniform(random) < 0.5)
+            motionAmplitude = -motionAmplitude;
+    }
+
+    SensorData PPGGenerator::next(double interval)
+    {
+        double dt = interval / 1000.0;
+
+        double pulse = sin(pulsePhase) + 0.5 * sin(2 * pulsePhase + 0.4) +
+                       0.2 * sin(3 * pulsePhase + 1.1);
+        double breathing = sin(breathingPhase);
+
+        double dc = settings.baseline + settings.drift / 60.0 * time +
+                    settings.breathingAmplitude * breathing;
+        double ac = settings.amplitude * pulse;
+
+        // Both channels see the same motion, as the light path changes.
+        double motion = 0.0;
+        if (time < motionEnd) {
+            double remaining = motionEnd - time;
+            motion = motionAmplitude * sin(2 * M_PI * motionFrequency * remaining);
+        }
+
+        double broadband = dc + ac + motion + settings.noise * gaussian(random);
+        double ir = settings.irRatio * (dc + motion) +
+                    settings.irRatio * settings.irPulseRatio * ac +
+                    settings.irRatio * settings.noise * gaussian(random);
+
+        SensorData data;
+        data.broadband = (uint16_t) std::min(std::max(broadband, 0.0), 65535.0);
+        data.ir = (uint16_t) std::min(std::max(ir, 0.0), 65535.0);
+
+        // Phases accumulate, so rate changes do not jump.
+        pulsePhase = fmod(pulsePhase + 2 * M_PI * settings.heartRate / 60.0 * dt, 2 * M_PI);
+        breathingPhase = fmod(breathingPhase + 2 * M_PI * settings.breathingRate / 60.0 * dt,
+                              2 * M_PI);
+        time += dt;
+
+        updateMotion(dt);
+
+        return data;
+    }
+
+    void PPGGenerator::setSettings(const PPGSettings &settings)
+    {
+        this->settings = settings;
+    }
+
+    const PPGSettings &PPGGenerator::getSettings()
+    {
+        return settings;
+    }
+
+    double PPGGenerator::getTime()
+    {
+        return time;
+    }
+
+}
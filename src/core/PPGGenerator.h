@@ -0,0 +1,89 @@
+/**
+ * Synthetic photoplethysmogram in sensor units (broadband and IR), as
+ * measured by the light sensor.
+ *
+ * The signal is the sum of:
+ * - pulse: fundamental at the heart rate with two harmonics
+ * - breathing: slow sine on the baseline
+ * - drift: linear change of the baseline
+ * - motion artifacts: random bursts of large, low frequency swings
+ * - gaussian noise
+ *
+ * The same settings and seed give the same samples.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef PPG_GENERATOR_H
+#define PPG_GENERATOR_H
+
+#include <stdint.h>
+
+#include <random>
+
+#include "SensorProtocol.h"
+
+namespace hrm
+{
+
+    struct PPGSettings {
+        double heartRate = 72.0; // bpm
+        double amplitude = 400.0; // Pulse amplitude
+        double baseline = 20000.0;
+        double breathingRate = 15.0; // per minute
+        double breathingAmplitude = 300.0;
+        double drift = 0.0; // Baseline change per minute
+        double noise = 50.0; // Standard deviation
+        double motionRate = 0.0; // Artifacts per minute
+        double motionAmplitude = 3000.0;
+
+        // IR relative to broadband: DC level and pulse amplitude
+        double irRatio = 0.4;
+        double irPulseRatio = 0.6;
+
+        uint32_t seed = 1;
+    };
+
+    class PPGGenerator
+    {
+        private:
+            PPGSettings settings;
+
+            std::mt19937 random;
+            std::normal_distribution<double> gaussian;
+            std::uniform_real_distribution<double> uniform;
+
+            double time = 0.0; // s
+            double pulsePhase = 0.0; // rad
+            double breathingPhase = 0.0;
+
+            // Current motion artifact
+            double motionEnd = 0.0; // s
+            double motionFrequency = 0.0; // Hz
+            double motionAmplitude = 0.0;
+
+            void updateMotion(double interval);
+
+        public:
+            PPGGenerator(const PPGSettings &settings = PPGSettings());
+
+            /**
+             * @param interval Time since the last sample (ms).
+             */
+            SensorData next(double interval);
+
+            /**
+             * Keeps the time and phases, so the signal stays continuous.
+             */
+            void setSettings(const PPGSettings &settings);
+            const PPGSettings &getSettings();
+
+            /**
+             * @return Seconds since the first sample.
+             */
+            double getTime();
+    };
+
+}
+
+#endif
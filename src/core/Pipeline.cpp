@@ -0,0 +1,133 @@
+#include "Pipeline.h"
+
+#include <cstdlib>
+
+namespace hrm
+{
+
+    Pipeline::Pipeline(double sampleInterval) :
+        fft(sampleInterval),
+        beatDetector(sampleInterval, DEFAULT_MIN_FREQUENCY, DEFAULT_MAX_FREQUENCY)
+    {
+    }
+
+    bool Pipeline::push(double sample)
+    {
+        // push(const double *) would read the other channels.
+        if (fft.getChannels() != 1)
+            return false;
+
+        return push(&sample);
+    }
+
+    bool Pipeline::push(const double *samples)
+    {
+        // Before the FFT, so beats are not delayed by it.
+        if (useBeatDetector && beatDetector.addSample(samples[0]) && beatCallback)
+            beatCallback(beatDetector.getLastBeat());
+
+        if (!fft.addSamples(samples))
+            return false;
+
+        timing.bufferFull = fft.getBufferFullTime();
+        timing.fftDone = Statistics::now();
+
+        Peak peak = fft.getPeak();
+        timing.peakFound = Statistics::now();
+
+        if (spectrumCallback)
+            spectrumCallback(fft, peak);
+        if (bpmCallback && peak.index >= 0)
+            bpmCallback(peak.frequency * 60, peak);
+
+        return true;
+    }
+
+    bool Pipeline::push(const SensorData &data)
+    {
+        if (dataCallback)
+            dataCallback(data);
+
+        double samples[SENSOR_CHANNELS] = {(double) data.broadband, (double) data.ir};
+        return push(samples);
+    }
+
+    LINE_TYPE Pipeline::pushLine(const std::string &line)
+    {
+        SensorData data;
+        SensorSettings settings;
+
+        LINE_TYPE type = SensorProtocol::parseLine(line, data, settings);
+
+        if (type == LINE_DATA) {
+            push(data);
+        } else if (type == LINE_SETTINGS) {
+            setSampleInterval(strtod(settings.sampleInterval.c_str(), nullptr));
+
+            if (settingsCallback)
+                settingsCallback(settings);
+        }
+
+        return type;
+    }
+
+    void Pipeline::setSampleInterval(double sampleInterval)
+    {
+        fft.setSampleInterval(sampleInterval);
+        beatDetector.setSampleInterval(sampleInterval);
+    }
+
+    void Pipeline::setSpectrumCallback(SpectrumCallback callback)
+    {
+        spectrumCallback = callback;
+    }
+
+    void Pipeline::setBpmCallback(BpmCallback callback)
+    {
+        bpmCallback = callback;
+    }
+
+    void Pipeline::setDataCallback(DataCallback callback)
+    {
+        dataCallback = callback;
+    }
+
+    void Pipeline::setSettingsCallback(SettingsCallback callback)
+    {
+        settingsCallback = callback;
+    }
+
+    void Pipeline::setBeatCallback(BeatCallback callback)
+    {
+        beatCallback = callback;
+    }
+
+    void Pipeline::setUseBeatDetector(bool status)
+    {
+        if (status && !useBeatDetector)
+            beatDetector.reset();
+
+        useBeatDetector = status;
+    }
+
+    bool Pipeline::isUsingBeatDetector()
+    {
+        return useBeatDetector;
+    }
+
+    FFT &Pipeline::getFFT()
+    {
+        return fft;
+    }
+
+    BeatDetector &Pipeline::getBeatDetector()
+    {
+        return beatDetector;
+    }
+
+    const PipelineTiming &Pipeline::getTiming()
+    {
+        return timing;
+    }
+
+}
@@ -0,0 +1,126 @@
+/**
+ * Push API of the signal processing pipeline (parsing + FFT), without
+ * any Qt dependency.
+ *
+ * Samples (or raw protocol lines) are pushed in, results are delivered
+ * through callbacks:
+ *
+ *   Pipeline pipeline(sampleInterval);
+ *   pipeline.setBpmCallback([](double bpm, const Peak &peak) { ... });
+ *   pipeline.push(sample);
+ *
+ * Optionally, the beat detector (see BeatDetector.h) runs on the first
+ * channel next to the FFT, each beat is delivered right away.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <functional>
+#include <string>
+
+#include "BeatDetector.h"
+#include "FFT.h"
+#include "SensorProtocol.h"
+
+namespace hrm
+{
+
+    // Statistics::now() timestamps of the last spectrum
+    struct PipelineTiming {
+        uint64_t bufferFull = 0;
+        uint64_t fftDone = 0;
+        uint64_t peakFound = 0;
+    };
+
+    class Pipeline
+    {
+        public:
+            // Called after each calculated spectrum (fft holds the result).
+            typedef std::function<void(FFT &fft, const Peak &peak)> SpectrumCallback;
+            typedef std::function<void(double bpm, const Peak &peak)> BpmCallback;
+            typedef std::function<void(const SensorData &data)> DataCallback;
+            typedef std::function<void(const SensorSettings &settings)> SettingsCallback;
+            typedef std::function<void(const Beat &beat)> BeatCallback;
+
+        private:
+            FFT fft;
+            BeatDetector beatDetector;
+            bool useBeatDetector = false;
+
+            SpectrumCallback spectrumCallback;
+            BpmCallback bpmCallback;
+            DataCallback dataCallback;
+            SettingsCallback settingsCallback;
+            BeatCallback beatCallback;
+
+            PipelineTiming timing;
+
+        public:
+            /**
+             * @param sampleInterval ms
+             */
+            Pipeline(double sampleInterval);
+
+            /**
+             * Processes one sample (single channel FFT only).
+             *
+             * @retval true A new spectrum was calculated (callbacks called).
+             * @retval false Not yet, or the FFT has more channels.
+             */
+            bool push(double sample);
+
+            /**
+             * Processes one sample per channel of the FFT.
+             */
+            bool push(const double *samples);
+
+            /**
+             * Processes the broadband channel of the sensor data, or
+             * broadband and IR (SENSOR_CHANNEL order) if the FFT has
+             * more channels. The BPM is the peak of the broadband
+             * channel.
+             */
+            bool push(const SensorData &data);
+
+            /**
+             * Of the FFT and the beat detector.
+             *
+             * @param sampleInterval ms
+             */
+            void setSampleInterval(double sampleInterval);
+
+            /**
+             * Parses a protocol line. Data lines are processed, settings
+             * lines update the sample interval.
+             *
+             * @return The type of the line.
+             */
+            LINE_TYPE pushLine(const std::string &line);
+
+            void setSpectrumCallback(SpectrumCallback callback);
+            void setBpmCallback(BpmCallback callback);
+            void setDataCallback(DataCallback callback);
+            void setSettingsCallback(SettingsCallback callback);
+            void setBeatCallback(BeatCallback callback);
+
+            /**
+             * Enabling starts the detector with learning again.
+             */
+            void setUseBeatDetector(bool status);
+            bool isUsingBeatDetector();
+
+            FFT &getFFT();
+            BeatDetector &getBeatDetector();
+
+            /**
+             * Valid in the spectrum and bpm callbacks.
+             */
+            const PipelineTiming &getTiming();
+    };
+
+}
+
+#endif
@@ -0,0 +1,645 @@
+#include "Recording.h"
+#include "Trace.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define HEADER_FIXED_SIZE 26
+#define BLOCK_HEADER_SIZE 24
+#define INDEX_ENTRY_SIZE 24
+#define TRAILER_SIZE 16
+#define SAMPLE_SIZE 4
+
+namespace hrm
+{
+
+    static void put16(std::vector<uint8_t> &buffer, uint16_t value)
+    {
+        buffer.push_back(value & 0xFF);
+        buffer.push_back(value >> 8);
+    }
+
+    static void put32(std::vector<uint8_t> &buffer, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            buffer.push_back((value >> (8 * i)) & 0xFF);
+    }
+
+    static void put64(std::vector<uint8_t> &buffer, uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+            buffer.push_back((value >> (8 * i)) & 0xFF);
+    }
+
+    static void set32(uint8_t *p, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            p[i] = (value >> (8 * i)) & 0xFF;
+    }
+
+    static uint16_t get16(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8);
+    }
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+    }
+
+    static uint64_t get64(const uint8_t *p)
+    {
+        return get32(p) | ((uint64_t) get32(p + 4) << 32);
+    }
+
+    static void putMagic(std::vector<uint8_t> &buffer, const char *magic)
+    {
+        buffer.insert(buffer.end(), magic, magic + 4);
+    }
+
+    static bool isMagic(const uint8_t *p, const char *magic)
+    {
+        return memcmp(p, magic, 4) == 0;
+    }
+
+    static std::vector<const std::string *> settingsFields(const SensorSettings &settings)
+    {
+        return {&settings.sensor, &settings.id, &settings.max, &settings.min,
+                &settings.resolution, &settings.sampleInterval
+               };
+    }
+
+    RecordingWriter::~RecordingWriter()
+    {
+        close();
+    }
+
+    bool RecordingWriter::open(const std::string &fileName,
+                               const SensorSettings &settings,
+                               double sampleInterval)
+    {
+        close();
+
+        file = fopen(fileName.c_str(), "wb");
+        if (!file)
+            return false;
+
+        setvbuf(file, nullptr, _IOFBF, RECORDING_FILE_BUFFER);
+
+        uint64_t startTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch()).count();
+        uint64_t interval;
+        memcpy(&interval, &sampleInterval, sizeof(interval));
+
+        std::vector<uint8_t> header;
+        putMagic(header, "HRMR");
+        put16(header, RECORDING_VERSION);
+        put16(header, 0); // Header size, set below
+        put64(header, interval);
+        put64(header, startTime);
+        put16(header, RECORDING_BLOCK_SAMPLES);
+
+        for (const std::string *field : settingsFields(settings)) {
+            uint16_t length = std::min<size_t>(field->size(), 0xFFFF);
+            put16(header, length);
+            header.insert(header.end(), field->begin(), field->begin() + length);
+        }
+
+        header[6] = header.size() & 0xFF;
+        header[7] = header.size() >> 8;
+
+        if (fwrite(header.data(), 1, header.size(), file) != header.size()) {
+            fclose(file);
+            file = nullptr;
+            return false;
+        }
+
+        offset = header.size();
+        index.clear();
+        failed = false;
+        statistics = RecordingStatistics();
+        statistics.bytes = offset;
+
+        nextSample = 0;
+        currentCount = 0;
+        current.clear();
+        start = std::chrono::steady_clock::now();
+
+        running = true;
+        thread = std::thread(&RecordingWriter::run, this);
+
+        return true;
+    }
+
+    bool RecordingWriter::close()
+    {
+        if (!file)
+            return true;
+
+        endBlock();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        condition.notify_one();
+        thread.join();
+
+        writeIndex();
+
+        bool closed = fclose(file) == 0;
+        file = nullptr;
+
+        return closed && !hasFailed();
+    }
+
+    bool RecordingWriter::isOpen()
+    {
+        return file != nullptr;
+    }
+
+    bool RecordingWriter::hasFailed()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return failed;
+    }
+
+    void RecordingWriter::beginBlock()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!unused.empty()) {
+                current.swap(unused.back());
+                unused.pop_back();
+            }
+        }
+
+        blockStart = std::chrono::steady_clock::now();
+        uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 blockStart - start).count();
+
+        current.clear();
+        current.reserve(BLOCK_HEADER_SIZE + RECORDING_BLOCK_SAMPLES * SAMPLE_SIZE);
+        putMagic(current, "HRMB");
+        put32(current, 0); // Count, set in endBlock()
+        put64(current, nextSample);
+        put64(current, timestamp);
+    }
+
+    void RecordingWriter::endBlock()
+    {
+        if (currentCount == 0)
+            return;
+
+        set32(&current[4], currentCount);
+        nextSample += currentCount;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (pending.size() < RECORDING_MAX_PENDING) {
+                pending.push_back(std::vector<uint8_t>());
+                pending.back().swap(current);
+                statistics.samples += currentCount;
+            } else {
+                ++statistics.droppedBlocks;
+                statistics.droppedSamples += currentCount;
+            }
+        }
+        condition.notify_one();
+
+        currentCount = 0;
+    }
+
+    void RecordingWriter::add(const SensorData *data, int count)
+    {
+        if (!file)
+            return;
+
+        for (int i = 0; i < count; ++i) {
+            if (currentCount == 0)
+                beginBlock();
+
+            put16(current, data[i].broadband);
+            put16(current, data[i].ir);
+
+            if (++currentCount == RECORDING_BLOCK_SAMPLES)
+                endBlock();
+        }
+
+        if (currentCount > 0 &&
+                std::chrono::steady_clock::now() - blockStart >
+                std::chrono::milliseconds(RECORDING_BLOCK_DURATION))
+            endBlock();
+    }
+
+    void RecordingWriter::run()
+    {
+        Trace::instance().setThreadName("Recording writer");
+
+        std::vector<uint8_t> block;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+
+                if (!block.empty())
+                    unused.push_back(std::move(block));
+
+                condition.wait(lock, [this] {
+                    return !pending.empty() || !running;
+                });
+
+                if (pending.empty())
+                    return;
+
+                block.swap(pending.front());
+                pending.pop_front();
+            }
+
+            RecordingBlock entry;
+            entry.offset = offset;
+            entry.count = get32(&block[4]);
+            entry.firstSample = get64(&block[8]);
+            entry.timestamp = get64(&block[16]);
+            index.push_back(entry);
+
+            bool written = fwrite(block.data(), 1, block.size(), file) == block.size() &&
+                           fflush(file) == 0;
+            offset += block.size();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (written)
+                    ++statistics.blocks;
+                else
+                    failed = true;
+                statistics.bytes = offset;
+            }
+        }
+    }
+
+    void RecordingWriter::writeIndex()
+    {
+        std::vector<uint8_t> buffer;
+        buffer.reserve(8 + index.size() * INDEX_ENTRY_SIZE + TRAILER_SIZE);
+
+        putMagic(buffer, "HRMI");
+        put32(buffer, index.size());
+        for (const RecordingBlock &entry : index) {
+            put64(buffer, entry.offset);
+            put64(buffer, entry.firstSample);
+            put64(buffer, entry.timestamp);
+        }
+
+        put64(buffer, offset);
+        putMagic(buffer, "HRMX");
+        put32(buffer, 0);
+
+        bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() &&
+                       fflush(file) == 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!written)
+            failed = true;
+        statistics.bytes = offset + buffer.size();
+    }
+
+    RecordingStatistics RecordingWriter::getStatistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return statistics;
+    }
+
+    RecordingReader::~RecordingReader()
+    {
+        close();
+    }
+
+    bool RecordingReader::open(const std::string &fileName)
+    {
+        close();
+
+        if (!map(fileName))
+            return false;
+
+        size_t headerSize;
+        if (!readHeader(headerSize)) {
+            close();
+            return false;
+        }
+
+        // A damaged index would make read() leave the mapping.
+        bool found;
+        if (!readIndex(headerSize, found)) {
+            close();
+            return false;
+        }
+        if (!found)
+            scanBlocks(headerSize);
+
+        return true;
+    }
+
+    void RecordingReader::close()
+    {
+        unmap();
+
+        index.clear();
+        settings = SensorSettings();
+        sampleInterval = 0.0;
+        startTime = 0;
+    }
+
+#ifdef _WIN32
+    bool RecordingReader::map(const std::string &fileName)
+    {
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        data = (const uint8_t *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        size = fileSize.QuadPart;
+        fileHandle = file;
+        mappingHandle = mapping;
+        return true;
+    }
+
+    void RecordingReader::unmap()
+    {
+        if (data)
+            UnmapViewOfFile(data);
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+        if (fileHandle)
+            CloseHandle(fileHandle);
+
+        data = nullptr;
+        size = 0;
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+    }
+#else
+    bool RecordingReader::map(const std::string &fileName)
+    {
+        fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat status;
+        if (fstat(fd, &status) != 0 || status.st_size == 0) {
+            unmap();
+            return false;
+        }
+
+        void *p = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            unmap();
+            return false;
+        }
+
+        data = (const uint8_t *) p;
+        size = status.st_size;
+        return true;
+    }
+
+    void RecordingReader::unmap()
+    {
+        if (data)
+            munmap((void *) data, size);
+        if (fd >= 0)
+            ::close(fd);
+
+        data = nullptr;
+        size = 0;
+        fd = -1;
+    }
+#endif
+
+    bool RecordingReader::readHeader(size_t &headerSize)
+    {
+        if (size < HEADER_FIXED_SIZE || !isMagic(data, "HRMR") ||
+                get16(data + 4) != RECORDING_VERSION)
+            return false;
+
+        headerSize = get16(data + 6);
+        if (headerSize < HEADER_FIXED_SIZE || headerSize > size)
+            return false;
+
+        uint64_t interval = get64(data + 8);
+        memcpy(&sampleInterval, &interval, sizeof(sampleInterval));
+        startTime = get64(data + 16);
+
+        std::string *fields[] = {&settings.sensor, &settings.id, &settings.max,
+                                 &settings.min, &settings.resolution,
+                                 &settings.sampleInterval
+                                };
+
+        size_t position = HEADER_FIXED_SIZE;
+        for (std::string *field : fields) {
+            if (position + 2 > headerSize)
+                return false;
+
+            uint16_t length = get16(data + position);
+            position += 2;
+            if (position + length > headerSize)
+                return false;
+
+            field->assign((const char *) data + position, length);
+            position += length;
+        }
+
+        return true;
+    }
+
+    bool RecordingReader::readIndex(size_t headerSize, bool &found)
+    {
+        found = false;
+        if (size < headerSize + 8 + TRAILER_SIZE)
+            return true;
+
+        const uint8_t *trailer = data + size - TRAILER_SIZE;
+        if (!isMagic(trailer + 8, "HRMX"))
+            return true;
+
+        found = true;
+
+        uint64_t indexOffset = get64(trailer);
+        if (indexOffset < headerSize || indexOffset > size - TRAILER_SIZE - 8 ||
+                !isMagic(data + indexOffset, "HRMI"))
+            return false;
+
+        uint32_t blockCount = get32(data + indexOffset + 4);
+        if ((uint64_t) blockCount * INDEX_ENTRY_SIZE > size - TRAILER_SIZE - 8 - indexOffset)
+            return false;
+
+        index.resize(blockCount);
+        const uint8_t *p = data + indexOffset + 8;
+        for (uint32_t i = 0; i < blockCount; ++i, p += INDEX_ENTRY_SIZE) {
+            index[i].offset = get64(p);
+            index[i].firstSample = get64(p + 8);
+            index[i].timestamp = get64(p + 16);
+
+            // The whole block has to lie between the header and the index.
+            uint64_t offset = index[i].offset;
+            if (offset < headerSize || offset > indexOffset - BLOCK_HEADER_SIZE ||
+                    !isMagic(data + offset, "HRMB")) {
+                index.clear();
+                return false;
+            }
+
+            index[i].count = get32(data + offset + 4);
+            if ((uint64_t) index[i].count * SAMPLE_SIZE >
+                    indexOffset - BLOCK_HEADER_SIZE - offset) {
+                index.clear();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void RecordingReader::scanBlocks(size_t headerSize)
+    {
+        size_t position = headerSize;
+
+        while (position + BLOCK_HEADER_SIZE <= size &&
+                isMagic(data + position, "HRMB")) {
+            RecordingBlock entry;
+            entry.offset = position;
+            entry.count = get32(data + position + 4);
+            entry.firstSample = get64(data + position + 8);
+            entry.timestamp = get64(data + position + 16);
+
+            uint64_t blockSize = BLOCK_HEADER_SIZE + (uint64_t) entry.count * SAMPLE_SIZE;
+            // Incomplete last block
+            if (blockSize > size - position)
+                break;
+
+            index.push_back(entry);
+            position += blockSize;
+        }
+    }
+
+    const SensorSettings &RecordingReader::getSettings()
+    {
+        return settings;
+    }
+
+    double RecordingReader::getSampleInterval()
+    {
+        return sampleInterval;
+    }
+
+    uint64_t RecordingReader::getStartTime()
+    {
+        return startTime;
+    }
+
+    uint64_t RecordingReader::getSampleCount()
+    {
+        if (index.empty())
+            return 0;
+        return index.back().firstSample + index.back().count;
+    }
+
+    size_t RecordingReader::getBlockCount()
+    {
+        return index.size();
+    }
+
+    const RecordingBlock &RecordingReader::getBlock(size_t i)
+    {
+        return index[i];
+    }
+
+    size_t RecordingReader::findBlock(uint64_t sample)
+    {
+        // First block that ends after the sample
+        auto it = std::upper_bound(index.begin(), index.end(), sample,
+        [](uint64_t s, const RecordingBlock & block) {
+            return s < block.firstSample + block.count;
+        });
+
+        return it - index.begin();
+    }
+
+    size_t RecordingReader::findBlockByTime(uint64_t timestamp)
+    {
+        auto it = std::upper_bound(index.begin(), index.end(), timestamp,
+        [](uint64_t t, const RecordingBlock & block) {
+            return t < block.timestamp;
+        });
+
+        return it == index.begin() ? 0 : (it - index.begin()) - 1;
+    }
+
+    size_t RecordingReader::readBlock(size_t block, SensorData *out, size_t count)
+    {
+        if (block >= index.size())
+            return 0;
+
+        count = std::min<size_t>(count, index[block].count);
+        const uint8_t *p = data + index[block].offset + BLOCK_HEADER_SIZE;
+
+        for (size_t i = 0; i < count; ++i, p += SAMPLE_SIZE) {
+            out[i].broadband = get16(p);
+            out[i].ir = get16(p + 2);
+        }
+
+        return count;
+    }
+
+    size_t RecordingReader::read(uint64_t sample, SensorData *out, size_t count)
+    {
+        size_t copied = 0;
+
+        for (size_t block = findBlock(sample); block < index.size() && copied < count; ++block) {
+            const RecordingBlock &entry = index[block];
+
+            uint64_t first = std::max(sample, entry.firstSample) - entry.firstSample;
+            size_t n = std::min<uint64_t>(count - copied, entry.count - first);
+
+            const uint8_t *p = data + entry.offset + BLOCK_HEADER_SIZE + first * SAMPLE_SIZE;
+            for (size_t i = 0; i < n; ++i, p += SAMPLE_SIZE) {
+                out[copied + i].broadband = get16(p);
+                out[copied + i].ir = get16(p + 2);
+            }
+
+            copied += n;
+        }
+
+        return copied;
+    }
+
+}
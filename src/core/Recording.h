@@ -0,0 +1,221 @@
+/**
+ * Binary capture format for raw sensor sessions.
+ *
+ * All values are little endian.
+ *
+ * header:  "HRMR" | version u16 | headerSize u16 | sampleInterval f64 (ms)
+ *          | startTime u64 (us since epoch) | blockSamples u16
+ *          | 6 x (length u16 | bytes) sensor settings
+ * block:   "HRMB" | count u32 | firstSample u64 | timestamp u64 (us since
+ *          start) | count x (broadband u16 | ir u16)
+ * index:   "HRMI" | blockCount u32 | blockCount x (offset u64
+ *          | firstSample u64 | timestamp u64)
+ * trailer: indexOffset u64 | "HRMX" | 0 u32
+ *
+ * The index is written when the recording is closed. Without it (e.g.
+ * after a crash) the reader rebuilds it by walking the block headers.
+ *
+ * RecordingWriter: add() only copies the samples into the current
+ * block, full blocks are written by a background thread. If the disk
+ * cannot keep up, blocks are dropped (counted) instead of blocking the
+ * caller; the firstSample numbers of the following blocks show the gap.
+ *
+ * RecordingReader: Maps the file into memory (mmap), so opening a file
+ * of any length only reads the header and the index.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SensorProtocol.h"
+
+#define RECORDING_VERSION 1
+#define RECORDING_BLOCK_SAMPLES 4096
+// A partial block is written at the latest after this time.
+#define RECORDING_BLOCK_DURATION 1000 // ms
+// Blocks waiting for the writer thread before new blocks are dropped.
+#define RECORDING_MAX_PENDING 256
+#define RECORDING_FILE_BUFFER (1 << 20)
+
+namespace hrm
+{
+
+    struct RecordingBlock {
+        uint64_t offset = 0; // Of the block header in the file
+        uint64_t firstSample = 0;
+        uint64_t timestamp = 0; // us since start of the recording
+        uint32_t count = 0;
+    };
+
+    struct RecordingStatistics {
+        uint64_t samples = 0;
+        uint64_t blocks = 0;
+        uint64_t droppedBlocks = 0;
+        uint64_t droppedSamples = 0;
+        uint64_t bytes = 0;
+    };
+
+    class RecordingWriter
+    {
+        private:
+            FILE *file = nullptr;
+            std::thread thread;
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<std::vector<uint8_t>> pending;
+            std::vector<std::vector<uint8_t>> unused;
+            bool running = false;
+            bool failed = false; // A write failed
+
+            // Caller thread
+            std::vector<uint8_t> current;
+            uint32_t currentCount = 0;
+            uint64_t nextSample = 0;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::time_point blockStart;
+
+            // Writer thread
+            std::vector<RecordingBlock> index;
+            uint64_t offset = 0;
+
+            RecordingStatistics statistics;
+
+            void beginBlock();
+            void endBlock();
+            void run();
+            void writeIndex();
+
+        public:
+            ~RecordingWriter();
+
+            /**
+             * Creates the file and writes the header.
+             *
+             * @param sampleInterval ms
+             */
+            bool open(const std::string &fileName,
+                      const SensorSettings &settings,
+                      double sampleInterval);
+
+            /**
+             * Writes the pending blocks, the index and closes the file.
+             *
+             * @retval false A write failed, the file is incomplete.
+             */
+            bool close();
+
+            bool isOpen();
+
+            /**
+             * A write of the writer thread failed (e.g. disk full).
+             */
+            bool hasFailed();
+
+            /**
+             * Never waits for the disk.
+             */
+            void add(const SensorData *data, int count);
+
+            RecordingStatistics getStatistics();
+    };
+
+    class RecordingReader
+    {
+        private:
+            const uint8_t *data = nullptr;
+            size_t size = 0;
+
+#ifdef _WIN32
+            void *fileHandle = nullptr;
+            void *mappingHandle = nullptr;
+#else
+            int fd = -1;
+#endif
+
+            SensorSettings settings;
+            double sampleInterval = 0.0;
+            uint64_t startTime = 0;
+
+            std::vector<RecordingBlock> index;
+
+            bool map(const std::string &fileName);
+            void unmap();
+            bool readHeader(size_t &headerSize);
+            /**
+             * @param found The file has a trailer (was closed).
+             * @retval false The index or one of its blocks lies outside
+             * of the file.
+             */
+            bool readIndex(size_t headerSize, bool &found);
+            void scanBlocks(size_t headerSize);
+
+        public:
+            ~RecordingReader();
+
+            /**
+             * @retval false Not a recording, or its index points outside
+             * of the file.
+             */
+            bool open(const std::string &fileName);
+            void close();
+
+            const SensorSettings &getSettings();
+            double getSampleInterval();
+            uint64_t getStartTime();
+
+            /**
+             * @return Number of the sample after the last one (dropped
+             * blocks included).
+             */
+            uint64_t getSampleCount();
+
+            size_t getBlockCount();
+            const RecordingBlock &getBlock(size_t i);
+
+            /**
+             * @return The block containing the sample, or the first block
+             * after it (getBlockCount() if there is none).
+             */
+            size_t findBlock(uint64_t sample);
+
+            /**
+             * @return The last block starting at or before the timestamp
+             * (us since start).
+             */
+            size_t findBlockByTime(uint64_t timestamp);
+
+            /**
+             * Copies the samples of one block.
+             *
+             * @return Number of samples copied.
+             */
+            size_t readBlock(size_t block, SensorData *out, size_t count);
+
+            /**
+             * Copies up to count samples beginning at sample (samples of
+             * dropped blocks are skipped).
+             *
+             * @return Number of samples copied.
+             */
+            size_t read(uint64_t sample, SensorData *out, size_t count);
+    };
+
+}
+
+#endif
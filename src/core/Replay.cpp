@@ -0,0 +1,208 @@
+#include "Replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "LineParser.h"
+
+#define REPLAY_READ_SIZE 65536
+#define REPLAY_RUN_BLOCK 1024
+
+namespace hrm
+{
+
+    bool Replay::open(const std::string &fileName)
+    {
+        close();
+
+        if (reader.open(fileName)) {
+            binary = true;
+            settings = reader.getSettings();
+            sampleInterval = reader.getSampleInterval();
+            sampleCount = reader.getSampleCount();
+        } else if (!openLog(fileName)) {
+            return false;
+        }
+
+        // poll() divides by it.
+        if (!(sampleInterval > 0.0)) {
+            close();
+            return false;
+        }
+
+        rewind();
+        return true;
+    }
+
+    bool Replay::openLog(const std::string &fileName)
+    {
+        FILE *file = fopen(fileName.c_str(), "rb");
+        if (!file)
+            return false;
+
+        bool hasSettings = false;
+
+        LineParser parser;
+        parser.setDataCallback([this](const SensorData & data) {
+            samples.push_back(data);
+        });
+        // The first settings line determines the sample interval.
+        parser.setSettingsCallback([&](const SensorSettings & lineSettings) {
+            if (hasSettings)
+                return;
+
+            hasSettings = true;
+            settings = lineSettings;
+
+            double interval = atof(lineSettings.sampleInterval.c_str());
+            if (interval > 0.0)
+                sampleInterval = interval;
+        });
+
+        std::vector<char> buffer;
+        size_t size = 0;
+        buffer.resize(REPLAY_READ_SIZE);
+
+        for (;;) {
+            size_t n = fread(buffer.data() + size, 1, buffer.size() - size, file);
+            size += n;
+
+            // Last line without line break
+            if (n == 0 && size > 0 && buffer[size - 1] != '\n')
+                buffer[size++] = '\n';
+
+            size_t consumed = parser.parse(buffer.data(), size);
+            memmove(buffer.data(), buffer.data() + consumed, size - consumed);
+            size -= consumed;
+
+            if (n == 0)
+                break;
+        }
+
+        fclose(file);
+
+        sampleCount = samples.size();
+        return sampleCount > 0;
+    }
+
+    void Replay::close()
+    {
+        reader.close();
+        binary = false;
+
+        samples.clear();
+        settings = SensorSettings();
+        sampleInterval = REPLAY_DEFAULT_SAMPLE_INTERVAL;
+        sampleCount = 0;
+        position = 0;
+    }
+
+    const SensorSettings &Replay::getSettings()
+    {
+        return settings;
+    }
+
+    double Replay::getSampleInterval()
+    {
+        return sampleInterval;
+    }
+
+    uint64_t Replay::getSampleCount()
+    {
+        return sampleCount;
+    }
+
+    void Replay::setPacing(REPLAY_PACING pacing, double speed)
+    {
+        this->pacing = pacing;
+        this->speed = speed > 0.0 ? speed : 1.0;
+    }
+
+    void Replay::rewind()
+    {
+        position = 0;
+        start = std::chrono::steady_clock::now();
+    }
+
+    size_t Replay::poll(SensorData *out, size_t count)
+    {
+        uint64_t end = sampleCount;
+
+        if (pacing == REPLAY_REAL_TIME) {
+            double elapsed = std::chrono::duration<double, std::milli>(
+                                 std::chrono::steady_clock::now() - start).count();
+            // Samples with a virtual time up to now
+            uint64_t due = (uint64_t)(elapsed * speed / sampleInterval) + 1;
+            end = std::min(end, due);
+        }
+
+        if (binary) {
+            size_t block = reader.findBlock(position);
+            if (block == reader.getBlockCount()) {
+                position = sampleCount;
+                return 0;
+            }
+
+            // Dropped blocks: The samples of the gap are not delivered,
+            // but their time passes.
+            const RecordingBlock &entry = reader.getBlock(block);
+            position = std::max(position, entry.firstSample);
+
+            // Within one block, so the positions stay aligned.
+            end = std::min(end, entry.firstSample + entry.count);
+        }
+
+        if (position >= end)
+            return 0;
+
+        count = std::min<uint64_t>(count, end - position);
+
+        if (binary) {
+            count = reader.read(position, out, count);
+        } else {
+            std::copy(samples.begin() + position,
+                      samples.begin() + position + count, out);
+        }
+
+        position += count;
+        return count;
+    }
+
+    double Replay::getTime()
+    {
+        return position * sampleInterval;
+    }
+
+    uint64_t Replay::getPosition()
+    {
+        return position;
+    }
+
+    bool Replay::atEnd()
+    {
+        return position >= sampleCount;
+    }
+
+    uint64_t Replay::run(Pipeline &pipeline)
+    {
+        REPLAY_PACING oldPacing = pacing;
+        pacing = REPLAY_FAST;
+
+        SensorData block[REPLAY_RUN_BLOCK];
+        uint64_t pushed = 0;
+
+        while (!atEnd()) {
+            size_t n = poll(block, REPLAY_RUN_BLOCK);
+            for (size_t i = 0; i < n; ++i)
+                pipeline.push(block[i]);
+            pushed += n;
+        }
+
+        pacing = oldPacing;
+        return pushed;
+    }
+
+}
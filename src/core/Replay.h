@@ -0,0 +1,112 @@
+/**
+ * Replays a recorded sensor session.
+ *
+ * Sources are binary recordings (see Recording.h) and text logs of the
+ * sensor output (the lines of the text protocol, settings lines are
+ * optional). The samples are delivered on a virtual clock: sample k is
+ * due at k * sampleInterval. With REPLAY_REAL_TIME the clock follows the
+ * wall clock (times speed), with REPLAY_FAST every sample is due at
+ * once.
+ *
+ * The delivered samples do not depend on the pacing or on how they are
+ * polled. Together with deterministic FFT plans (FFT::setDeterministic())
+ * the pipeline output is bit-identical across runs.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Pipeline.h"
+#include "Recording.h"
+#include "SensorProtocol.h"
+
+// Used if a text log has no settings line.
+#define REPLAY_DEFAULT_SAMPLE_INTERVAL 20.0 // ms
+
+namespace hrm
+{
+
+    enum REPLAY_PACING {REPLAY_REAL_TIME, REPLAY_FAST};
+
+    class Replay
+    {
+        private:
+            // Binary recording, read from the mapped file.
+            RecordingReader reader;
+            bool binary = false;
+
+            // Text log, parsed on open.
+            std::vector<SensorData> samples;
+
+            SensorSettings settings;
+            double sampleInterval = REPLAY_DEFAULT_SAMPLE_INTERVAL;
+            uint64_t sampleCount = 0;
+
+            REPLAY_PACING pacing = REPLAY_FAST;
+            double speed = 1.0;
+
+            uint64_t position = 0;
+            std::chrono::steady_clock::time_point start;
+
+            bool openLog(const std::string &fileName);
+
+        public:
+            /**
+             * Detects the format by the file content.
+             *
+             * @retval false Unknown format, no samples or a sample
+             * interval of 0 or less.
+             */
+            bool open(const std::string &fileName);
+            void close();
+
+            const SensorSettings &getSettings();
+
+            /**
+             * @return ms
+             */
+            double getSampleInterval();
+            uint64_t getSampleCount();
+
+            void setPacing(REPLAY_PACING pacing, double speed = 1.0);
+
+            /**
+             * Starts the (virtual) clock at the first sample.
+             */
+            void rewind();
+
+            /**
+             * Copies the samples that are due (at most count).
+             *
+             * @return Number of samples copied.
+             */
+            size_t poll(SensorData *out, size_t count);
+
+            /**
+             * @return Virtual time of the next sample (ms).
+             */
+            double getTime();
+            uint64_t getPosition();
+            bool atEnd();
+
+            /**
+             * Pushes all (remaining) samples into the pipeline, ignoring
+             * the pacing.
+             *
+             * @return Number of samples pushed.
+             */
+            uint64_t run(Pipeline &pipeline);
+    };
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ * Bounded lock-free single-producer/single-consumer queue.
+ *
+ * Exactly one thread pushes and exactly one thread pops. Neither side
+ * ever blocks: push() fails if the queue is full, pop() fails if it is
+ * empty. What to do with an item that does not fit (drop it, keep
+ * only the newest, ...) is decided by the caller.
+ *
+ * The slots are preallocated and reused. prepare()/commit() fill a slot
+ * in place, so items holding vectors keep their capacity and pushing
+ * does not allocate after the first round.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Keeps head and tail on different cache lines.
+#define SPSC_CACHE_LINE 64
+
+namespace hrm
+{
+
+    template <typename T>
+    class SPSCQueue
+    {
+        private:
+            std::vector<T> slots;
+            size_t mask;
+
+            // Written by the consumer only.
+            alignas(SPSC_CACHE_LINE) std::atomic<size_t> head;
+            // Written by the producer only.
+            alignas(SPSC_CACHE_LINE) std::atomic<size_t> tail;
+
+            static size_t roundUp(size_t capacity) {
+                size_t size = 1;
+                while (size < capacity)
+                    size <<= 1;
+                return size;
+            }
+
+        public:
+            /**
+             * @param capacity Rounded up to a power of two.
+             */
+            SPSCQueue(size_t capacity) :
+                slots(roundUp(capacity)), mask(roundUp(capacity) - 1),
+                head(0), tail(0) {}
+
+            SPSCQueue(const SPSCQueue &) = delete;
+            SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+            // Producer
+
+            /**
+             * @return The next free slot (to be filled in place), nullptr
+             * if the queue is full. Publish it with commit().
+             */
+            T *prepare() {
+                size_t t = tail.load(std::memory_order_relaxed);
+                if (t - head.load(std::memory_order_acquire) > mask)
+                    return nullptr;
+                return &slots[t & mask];
+            }
+
+            void commit() {
+                tail.store(tail.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_release);
+            }
+
+            /**
+             * @retval false The queue is full, the item was not added.
+             */
+            bool push(const T &item) {
+                T *slot = prepare();
+                if (!slot)
+                    return false;
+
+                *slot = item;
+                commit();
+                return true;
+            }
+
+            // Consumer
+
+            /**
+             * @return The oldest item, nullptr if the queue is empty.
+             * It stays valid until pop().
+             */
+            T *front() {
+                size_t h = head.load(std::memory_order_relaxed);
+                if (h == tail.load(std::memory_order_acquire))
+                    return nullptr;
+                return &slots[h & mask];
+            }
+
+            void pop() {
+                head.store(head.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_release);
+            }
+
+            /**
+             * Moves the item out of the slot (a slot does not keep a
+             * reference to a popped shared_ptr).
+             *
+             * @retval false The queue is empty.
+             */
+            bool pop(T &item) {
+                T *slot = front();
+                if (!slot)
+                    return false;
+
+                item = std::move(*slot);
+                pop();
+                return true;
+            }
+
+            // Approximate if called while the other side is running.
+            size_t size() const {
+                return tail.load(std::memory_order_acquire) -
+                       head.load(std::memory_order_acquire);
+            }
+
+            size_t capacity() const {
+                return mask + 1;
+            }
+    };
+
+}
+
+#endif
@@ -0,0 +1,240 @@
+#include "SensorPool.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "Trace.h"
+
+namespace hrm
+{
+
+    SensorPool::SensorPool(int threads) : pool(threads)
+    {
+    }
+
+    SensorPool::~SensorPool()
+    {
+        pool.wait();
+    }
+
+    uint64_t SensorPool::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int SensorPool::addSensor(const std::string &name)
+    {
+        std::shared_ptr<Sensor> sensor = std::make_shared<Sensor>();
+        Sensor *s = sensor.get();
+
+        s->name = name;
+
+        s->parser.setDataCallback([s](const SensorData & data) {
+            if (!s->pipeline) {
+                ++s->droppedSamples;
+                return;
+            }
+
+            s->pipeline->push(data);
+            ++s->samples;
+        });
+        s->parser.setSettingsCallback([this, s](const SensorSettings & settings) {
+            receiveSettings(*s, settings);
+        });
+
+        std::lock_guard<std::mutex> lock(mutex);
+        s->id = nextId++;
+        sensors[s->id] = sensor;
+
+        return s->id;
+    }
+
+    void SensorPool::removeSensor(int id)
+    {
+        // A running task keeps the sensor until it is done.
+        std::lock_guard<std::mutex> lock(mutex);
+        sensors.erase(id);
+    }
+
+    std::shared_ptr<SensorPool::Sensor> SensorPool::find(int id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = sensors.find(id);
+        if (it == sensors.end())
+            return nullptr;
+        return it->second;
+    }
+
+    void SensorPool::feed(int id, const char *data, size_t size)
+    {
+        std::shared_ptr<Sensor> sensor = find(id);
+        if (!sensor || size == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(sensor->inputMutex);
+
+            if (sensor->input.size() + size > SENSOR_POOL_MAX_INPUT) {
+                sensor->droppedBytes += size;
+                return;
+            }
+
+            sensor->input.append(data, size);
+        }
+
+        if (!sensor->scheduled.exchange(true)) {
+            pool.submit([this, sensor] {
+                process(sensor);
+            });
+        }
+    }
+
+    void SensorPool::process(std::shared_ptr<Sensor> sensor)
+    {
+        TRACE_SCOPE("SensorPool::process");
+
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(sensor->inputMutex);
+
+                if (sensor->work.empty())
+                    sensor->work.swap(sensor->input);
+                else {
+                    sensor->work.append(sensor->input);
+                    sensor->input.clear();
+                }
+            }
+
+            size_t consumed = sensor->parser.parse(sensor->work.data(), sensor->work.size());
+            sensor->work.erase(0, consumed);
+            sensor->malformedLines.store(sensor->parser.getStatistics().malformedLines);
+
+            sensor->scheduled.store(false);
+
+            // Bytes fed meanwhile did not schedule a task.
+            {
+                std::lock_guard<std::mutex> lock(sensor->inputMutex);
+                if (sensor->input.empty())
+                    return;
+            }
+
+            if (sensor->scheduled.exchange(true))
+                return;
+        }
+    }
+
+    void SensorPool::receiveSettings(Sensor &sensor, const SensorSettings &settings)
+    {
+        double sampleInterval = strtod(settings.sampleInterval.c_str(), nullptr);
+        if (sampleInterval <= 0.0)
+            return;
+
+        if (sensor.pipeline) {
+            sensor.pipeline->setSampleInterval(sampleInterval);
+            return;
+        }
+
+        sensor.pipeline = std::unique_ptr<Pipeline>(new Pipeline(sampleInterval));
+
+        Sensor *s = &sensor;
+        sensor.pipeline->setBpmCallback([this, s](double bpm, const Peak &) {
+            s->bpm.store(bpm);
+            s->bpmTime.store(now());
+            ++s->spectra;
+
+            if (bpmCallback)
+                bpmCallback(s->id, bpm);
+        });
+
+        sensor.configured.store(true);
+    }
+
+    void SensorPool::wait()
+    {
+        pool.wait();
+    }
+
+    bool SensorPool::isConfigured(int id)
+    {
+        std::shared_ptr<Sensor> sensor = find(id);
+        return sensor && sensor->configured.load();
+    }
+
+    void SensorPool::setBpmCallback(BpmCallback callback)
+    {
+        bpmCallback = callback;
+    }
+
+    std::vector<SensorStatus> SensorPool::getStatus()
+    {
+        std::vector<SensorStatus> result;
+        uint64_t time = now();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        result.reserve(sensors.size());
+
+        for (auto &entry : sensors) {
+            Sensor &sensor = *entry.second;
+            SensorStatus status;
+
+            status.id = sensor.id;
+            status.name = sensor.name;
+            status.configured = sensor.configured.load();
+            status.bpm = sensor.bpm.load();
+
+            uint64_t bpmTime = sensor.bpmTime.load();
+            if (bpmTime)
+                status.bpmAge = (time - bpmTime) / 1e9;
+
+            status.samples = sensor.samples.load();
+            status.spectra = sensor.spectra.load();
+            status.malformedLines = sensor.malformedLines.load();
+            status.droppedSamples = sensor.droppedSamples.load();
+            status.droppedBytes = sensor.droppedBytes.load();
+
+            result.push_back(status);
+        }
+
+        return result;
+    }
+
+    SensorSummary SensorPool::getSummary(double timeout)
+    {
+        SensorSummary summary;
+        double sum = 0.0;
+
+        for (const SensorStatus &status : getStatus()) {
+            ++summary.sensors;
+            summary.samples += status.samples;
+
+            if (status.bpmAge < 0.0 || status.bpmAge > timeout)
+                continue;
+
+            if (summary.active == 0) {
+                summary.minBpm = status.bpm;
+                summary.maxBpm = status.bpm;
+            } else {
+                summary.minBpm = std::min(summary.minBpm, status.bpm);
+                summary.maxBpm = std::max(summary.maxBpm, status.bpm);
+            }
+
+            sum += status.bpm;
+            ++summary.active;
+        }
+
+        if (summary.active > 0)
+            summary.meanBpm = sum / summary.active;
+
+        return summary;
+    }
+
+    int SensorPool::getThreadCount()
+    {
+        return pool.getThreadCount();
+    }
+
+}
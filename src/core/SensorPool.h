@@ -0,0 +1,172 @@
+/**
+ * Processing of many sensors on a shared ThreadPool.
+ *
+ * Every sensor has its own parser and pipeline (created when the
+ * settings of the sensor are known, like in Acquisition). The raw
+ * protocol bytes of a sensor are fed from any thread (e.g. the serial
+ * I/O thread), the parsing and the FFT run as task on the pool:
+ *
+ *   SensorPool pool;
+ *   int id = pool.addSensor("/dev/ttyACM0");
+ *   pool.feed(id, data, size);
+ *   pool.getSummary().meanBpm;
+ *
+ * At most one task per sensor is queued or running, so the pipeline
+ * of a sensor is never used by two workers at once and its samples stay
+ * in order. Bytes fed while the task runs are processed by the same
+ * task. If a sensor gets more than SENSOR_POOL_MAX_INPUT unprocessed
+ * bytes, new bytes are dropped and counted.
+ *
+ * Only the text protocol is supported.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef SENSOR_POOL_H
+#define SENSOR_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LineParser.h"
+#include "Pipeline.h"
+#include "ThreadPool.h"
+
+#define SENSOR_POOL_MAX_INPUT (1 << 20) // Bytes per sensor
+#define SENSOR_ACTIVE_TIMEOUT 10.0 // s without BPM until inactive
+
+namespace hrm
+{
+
+    struct SensorStatus {
+        int id = -1;
+        std::string name;
+
+        // The sensor settings are known.
+        bool configured = false;
+        // BPM of the last spectrum, 0 if none yet
+        double bpm = 0.0;
+        // Seconds since the last BPM, negative if none yet
+        double bpmAge = -1.0;
+
+        uint64_t samples = 0;
+        uint64_t spectra = 0;
+        uint64_t malformedLines = 0;
+        // Samples before the settings were known
+        uint64_t droppedSamples = 0;
+        uint64_t droppedBytes = 0;
+    };
+
+    // Over the sensors with a BPM not older than the timeout.
+    struct SensorSummary {
+        int sensors = 0;
+        int active = 0;
+        double meanBpm = 0.0;
+        double minBpm = 0.0;
+        double maxBpm = 0.0;
+        uint64_t samples = 0;
+    };
+
+    class SensorPool
+    {
+        public:
+            // Called on a pool thread.
+            typedef std::function<void(int id, double bpm)> BpmCallback;
+
+        private:
+            struct Sensor {
+                int id;
+                std::string name;
+
+                // Fed bytes, not processed yet
+                std::mutex inputMutex;
+                std::string input;
+                std::atomic<bool> scheduled;
+
+                // Task only
+                std::string work;
+                LineParser parser;
+                std::unique_ptr<Pipeline> pipeline;
+
+                std::atomic<bool> configured;
+                std::atomic<double> bpm;
+                std::atomic<uint64_t> bpmTime;
+                std::atomic<uint64_t> samples;
+                std::atomic<uint64_t> spectra;
+                std::atomic<uint64_t> malformedLines;
+                std::atomic<uint64_t> droppedSamples;
+                std::atomic<uint64_t> droppedBytes;
+
+                Sensor() : scheduled(false), configured(false), bpm(0.0), bpmTime(0),
+                    samples(0), spectra(0), malformedLines(0), droppedSamples(0),
+                    droppedBytes(0) {}
+            };
+
+            ThreadPool pool;
+
+            std::mutex mutex;
+            std::map<int, std::shared_ptr<Sensor>> sensors;
+            int nextId = 0;
+
+            BpmCallback bpmCallback;
+
+            std::shared_ptr<Sensor> find(int id);
+            void process(std::shared_ptr<Sensor> sensor);
+            void receiveSettings(Sensor &sensor, const SensorSettings &settings);
+
+            static uint64_t now();
+
+        public:
+            /**
+             * @param threads Workers of the pool, 0 for one per core.
+             */
+            SensorPool(int threads = 0);
+            ~SensorPool();
+
+            SensorPool(const SensorPool &) = delete;
+            SensorPool &operator=(const SensorPool &) = delete;
+
+            /**
+             * @return Id of the sensor.
+             */
+            int addSensor(const std::string &name);
+
+            /**
+             * Queued bytes of the sensor are discarded.
+             */
+            void removeSensor(int id);
+
+            /**
+             * Queues raw protocol bytes of the sensor (any thread).
+             */
+            void feed(int id, const char *data, size_t size);
+
+            /**
+             * Blocks until all fed bytes are processed.
+             */
+            void wait();
+
+            bool isConfigured(int id);
+
+            /**
+             * Set before feeding.
+             */
+            void setBpmCallback(BpmCallback callback);
+
+            std::vector<SensorStatus> getStatus();
+            SensorSummary getSummary(double timeout = SENSOR_ACTIVE_TIMEOUT);
+
+            int getThreadCount();
+    };
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "SensorProtocol.h"
+
+#include <cstring>
+
+#define MAX_WORDS 16
+
+namespace hrm
+{
+
+    const std::string SensorProtocol::GET_SETTINGS = "get settings";
+    const std::string SensorProtocol::SET_SAMPLE_INTERVAL = "set sampleInterval ";
+    const std::string SensorProtocol::SET_PROTOCOL_BINARY = "set protocol binary";
+    const std::string SensorProtocol::SET_PROTOCOL_ASCII = "set protocol ascii";
+
+    static inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    static inline const char *skipSpaces(const char *p, const char *end)
+    {
+        while (p < end && isSpace(*p))
+            ++p;
+        return p;
+    }
+
+    /**
+     * Matches the keyword followed by at least one space (or the end).
+     */
+    static inline const char *matchWord(const char *p, const char *end,
+                                        const char *word, size_t length)
+    {
+        if ((size_t)(end - p) < length || memcmp(p, word, length) != 0)
+            return nullptr;
+
+        p += length;
+        if (p < end && !isSpace(*p))
+            return nullptr;
+
+        return skipSpaces(p, end);
+    }
+
+    static inline const char *matchNumber(const char *p, const char *end,
+                                          uint16_t &value)
+    {
+        uint32_t number = 0;
+        const char *start = p;
+
+        while (p < end && *p >= '0' && *p <= '9') {
+            number = number * 10 + (*p - '0');
+            if (number > 0xFFFF)
+                return nullptr;
+            ++p;
+        }
+
+        if (p == start || (p < end && !isSpace(*p)))
+            return nullptr;
+
+        value = number;
+        return skipSpaces(p, end);
+    }
+
+    bool SensorProtocol::parseDataLine(const char *begin, const char *end,
+                                       SensorData &data)
+    {
+        const char *p = skipSpaces(begin, end);
+
+        if (!(p = matchWord(p, end, "data:", 5)))
+            return false;
+        if (!(p = matchWord(p, end, "broadband", 9)))
+            return false;
+        if (!(p = matchNumber(p, end, data.broadband)))
+            return false;
+        if (!(p = matchWord(p, end, "ir", 2)))
+            return false;
+        if (!(p = matchNumber(p, end, data.ir)))
+            return false;
+
+        return p == end;
+    }
+
+    LINE_TYPE SensorProtocol::parseLine(const char *begin, const char *end,
+                                        SensorData &data,
+                                        SensorSettings &settings)
+    {
+        // Fast path, by far the most lines are data lines.
+        if (parseDataLine(begin, end, data))
+            return LINE_DATA;
+
+        // Split into words (in place)
+        const char *words[MAX_WORDS];
+        size_t lengths[MAX_WORDS];
+        int count = 0;
+
+        const char *p = skipSpaces(begin, end);
+        while (p < end && count < MAX_WORDS) {
+            const char *start = p;
+            while (p < end && !isSpace(*p))
+                ++p;
+
+            words[count] = start;
+            lengths[count] = p - start;
+            ++count;
+
+            p = skipSpaces(p, end);
+        }
+
+        if (count >= 13 && lengths[0] == 9 && memcmp(words[0], "settings:", 9) == 0) {
+            settings.sensor.assign(words[2], lengths[2]);
+            settings.id.assign(words[4], lengths[4]);
+            settings.max.assign(words[6], lengths[6]);
+            settings.min.assign(words[8], lengths[8]);
+            settings.resolution.assign(words[10], lengths[10]);
+            settings.sampleInterval.assign(words[12], lengths[12]);
+
+            return LINE_SETTINGS;
+        }
+
+        return LINE_INVALID;
+    }
+
+    LINE_TYPE SensorProtocol::parseLine(const std::string &line,
+                                        SensorData &data,
+                                        SensorSettings &settings)
+    {
+        return parseLine(line.data(), line.data() + line.size(), data, settings);
+    }
+
+}
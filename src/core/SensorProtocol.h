@@ -0,0 +1,85 @@
+/**
+ * Parser for the text protocol of the light sensor.
+ *
+ * data: broadband <value> ir <value>
+ * settings: sensor <s> id <s> max <s> min <s> resolution <s> sampleInterval <s>
+ *
+ * It has no Qt dependency, so it can be used outside of the GUI.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef SENSOR_PROTOCOL_H
+#define SENSOR_PROTOCOL_H
+
+#include <stdint.h>
+
+#include <string>
+
+namespace hrm
+{
+
+    /**
+     * The data that can be received over serial.
+     */
+    struct SensorSettings {
+        std::string sensor;
+        std::string id;
+        std::string max;
+        std::string min;
+        std::string resolution;
+        std::string sampleInterval;
+    };
+
+    struct SensorData {
+        uint16_t broadband;
+        uint16_t ir;
+    };
+
+    // Channels of SensorData (processed in this order)
+    enum SENSOR_CHANNEL {CHANNEL_BROADBAND, CHANNEL_IR, SENSOR_CHANNELS};
+
+    enum LINE_TYPE {LINE_INVALID, LINE_DATA, LINE_SETTINGS};
+
+    class SensorProtocol
+    {
+        public:
+            static const std::string GET_SETTINGS;
+            static const std::string SET_SAMPLE_INTERVAL;
+
+            // Switches the data lines to the binary framing (FrameParser)
+            // and back.
+            static const std::string SET_PROTOCOL_BINARY;
+            static const std::string SET_PROTOCOL_ASCII;
+
+            /**
+             * Parses one line (without line break).
+             *
+             * @retval LINE_DATA data is set.
+             * @retval LINE_SETTINGS settings is set.
+             * @retval LINE_INVALID Unknown or malformed line.
+             */
+            static LINE_TYPE parseLine(const std::string &line,
+                                       SensorData &data,
+                                       SensorSettings &settings);
+
+            /**
+             * Same as above, but works in place on [begin, end). Data
+             * lines are parsed without any allocation.
+             */
+            static LINE_TYPE parseLine(const char *begin, const char *end,
+                                       SensorData &data,
+                                       SensorSettings &settings);
+
+            /**
+             * Scans "data: broadband <n> ir <n>" byte by byte.
+             *
+             * @retval false Not a (valid) data line.
+             */
+            static bool parseDataLine(const char *begin, const char *end,
+                                      SensorData &data);
+    };
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include "SlidingDFT.h"
+
+#include <cmath>
+
+#ifdef _WIN32
+const static double M_PI = 3.14159265359;
+#endif
+
+namespace hrm
+{
+
+    void SlidingDFT::setup(int size, int fftSize, int firstBin, int lastBin,
+                           int recomputeInterval)
+    {
+        this->size = size;
+        this->fftSize = fftSize;
+        this->firstBin = firstBin;
+        this->lastBin = lastBin;
+        this->recomputeInterval = recomputeInterval > 0 ? recomputeInterval : size;
+
+        int bins = lastBin >= firstBin ? lastBin - firstBin + 1 : 0;
+
+        state.assign(bins, 0.0);
+        rotation.resize(bins);
+        newest.resize(bins);
+        dcResponse.resize(bins);
+        goertzelCoeff.resize(bins);
+
+        for (int b = 0; b < bins; ++b) {
+            double w = 2 * M_PI * (firstBin + b) / fftSize;
+
+            rotation[b] = std::polar(1.0, w);
+            newest[b] = std::polar(1.0, -w * (size - 1));
+            goertzelCoeff[b] = 2.0 * cos(w);
+
+            std::complex<double> dc = 0.0;
+            for (int m = 0; m < size; ++m)
+                dc += std::polar(1.0, -w * m);
+            dcResponse[b] = dc;
+        }
+
+        history.assign(size, 0.0);
+        clear();
+    }
+
+    void SlidingDFT::clear()
+    {
+        std::fill(history.begin(), history.end(), 0.0);
+        std::fill(state.begin(), state.end(), 0.0);
+        pos = 0;
+        count = 0;
+        sum = 0.0;
+        sinceRecompute = 0;
+    }
+
+    bool SlidingDFT::add(double sample)
+    {
+        if (size <= 0)
+            return false;
+
+        // X(n) = e^(jw) * (X(n-1) - x(n-N)) + x(n) * e^(-jw(N-1))
+        double oldest = history[pos];
+        int bins = state.size();
+
+        for (int b = 0; b < bins; ++b)
+            state[b] = rotation[b] * (state[b] - oldest) + sample * newest[b];
+
+        sum += sample - oldest;
+        history[pos] = sample;
+        pos = (pos + 1 == size) ? 0 : pos + 1;
+
+        if (count < size)
+            ++count;
+
+        if (++sinceRecompute >= recomputeInterval)
+            recompute();
+
+        return count == size;
+    }
+
+    void SlidingDFT::recompute()
+    {
+        int bins = state.size();
+
+        for (int b = 0; b < bins; ++b) {
+            double s1 = 0.0;
+            double s2 = 0.0;
+
+            // Oldest to newest
+            for (int m = 0; m < size; ++m) {
+                double x = history[(pos + m) % size];
+                double s = x + goertzelCoeff[b] * s1 - s2;
+                s2 = s1;
+                s1 = s;
+            }
+
+            // y(N-1) = s1 - e^(-jw) s2 = sum x(m) e^(jw(N-1-m))
+            std::complex<double> y = s1 - std::conj(rotation[b]) * s2;
+            state[b] = y * newest[b];
+        }
+
+        // Also refresh the running sum.
+        sum = 0.0;
+        for (int m = 0; m < size; ++m)
+            sum += history[m];
+
+        sinceRecompute = 0;
+    }
+
+    std::complex<double> SlidingDFT::getBin(int bin)
+    {
+        int b = bin - firstBin;
+        double mean = sum / size;
+
+        return state[b] - mean * dcResponse[b];
+    }
+
+    double SlidingDFT::getValue(int i)
+    {
+        if (i < 0 || i >= size)
+            return 0.0;
+
+        return history[(pos + i) % size] - sum / size;
+    }
+
+    double SlidingDFT::getMean()
+    {
+        if (count == 0)
+            return 0.0;
+        return sum / count;
+    }
+
+    int SlidingDFT::getFirstBin()
+    {
+        return firstBin;
+    }
+
+    int SlidingDFT::getLastBin()
+    {
+        return lastBin;
+    }
+
+}
@@ -0,0 +1,95 @@
+/**
+ * Sliding DFT over the last N samples for a band of bins only.
+ *
+ * Each new sample updates every bin of the band in O(1), so a fresh
+ * spectrum is available after every sample at O(band bins) cost. The
+ * bins lie on the grid of a (zero padded) fftSize point DFT, so the
+ * result is directly comparable with the FFTW output.
+ *
+ * To bound the drift of the recursive update, the bins are periodically
+ * recomputed from the sample history with a Goertzel bank.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef SLIDING_DFT_H
+#define SLIDING_DFT_H
+
+#include <complex>
+#include <vector>
+
+namespace hrm
+{
+
+    class SlidingDFT
+    {
+        private:
+            int size = 0; // N (window length)
+            int fftSize = 0; // Grid of the bins
+            int firstBin = 0;
+            int lastBin = -1;
+
+            // Last N samples (ring buffer)
+            std::vector<double> history;
+            int pos = 0;
+            int count = 0;
+            double sum = 0.0;
+
+            int recomputeInterval = 0;
+            int sinceRecompute = 0;
+
+            // Per bin
+            std::vector<std::complex<double>> state;
+            std::vector<std::complex<double>> rotation; // e^(jw)
+            std::vector<std::complex<double>> newest; // e^(-jw(N-1))
+            std::vector<std::complex<double>> dcResponse; // DFT of a constant 1
+            std::vector<double> goertzelCoeff; // 2cos(w)
+
+            /**
+             * Goertzel bank over the history (removes accumulated
+             * rounding errors).
+             */
+            void recompute();
+
+        public:
+            /**
+             * @param size Number of samples in the window.
+             * @param fftSize Length of the DFT grid (size + zero padding).
+             * @param recomputeInterval Samples between two Goertzel
+             * recomputations (<= 0: size).
+             */
+            void setup(int size, int fftSize, int firstBin, int lastBin,
+                       int recomputeInterval = 0);
+
+            /**
+             * Adds a sample and updates all bins.
+             *
+             * @retval true The window is full, the bins are valid.
+             * @retval false Not enough samples yet.
+             */
+            bool add(double sample);
+
+            /**
+             * @return DFT of the mean free window at bin (firstBin <= bin <= lastBin).
+             */
+            std::complex<double> getBin(int bin);
+
+            /**
+             * @return Sample with index i of the current window (oldest first).
+             */
+            double getValue(int i);
+
+            /**
+             * @return Mean of the current window.
+             */
+            double getMean();
+
+            int getFirstBin();
+            int getLastBin();
+
+            void clear();
+    };
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "SpectrumFrame.h"
+
+#include <atomic>
+
+namespace hrm
+{
+
+    void SpectrumFrame::assign(FFT &fft, const Peak &peak)
+    {
+        properties = fft.getProperties();
+        this->peak = peak;
+
+        // Assignment reuses the capacity of the vectors.
+        magnitude = fft.getMagnitude();
+        real = fft.getRealPart();
+        imaginary = fft.getImaginaryPart();
+
+        input.resize(properties.numberOfSamples);
+        for (int i = 0; i < properties.numberOfSamples; ++i)
+            input[i] = fft.getInValue(i);
+
+        autocorrelationPeak = AutocorrelationPeak();
+        if (fft.isUsingAutocorrelation())
+            autocorrelationPeak = fft.getAutocorrelationPeak();
+
+        int channels = fft.getChannels();
+        channelPeaks.clear();
+        combinedPeak = Peak();
+        ratio = 0.0;
+
+        if (channels > 1) {
+            channelPeaks.push_back(peak);
+            for (int c = 1; c < channels; ++c)
+                channelPeaks.push_back(fft.getPeak(c));
+
+            combinedPeak = fft.getCombinedPeak();
+            if (channels > CHANNEL_IR)
+                ratio = fft.getRatio(CHANNEL_BROADBAND, CHANNEL_IR, combinedPeak.index);
+        }
+    }
+
+    double SpectrumFrame::indexToFrequency(double i) const
+    {
+        return properties.sampleRate * (i / (double) properties.totalSamples);
+    }
+
+    bool SpectrumFrame::isRequiredFrequency(int index) const
+    {
+        double f = indexToFrequency(index);
+
+        if (f < properties.minFrequency ||
+                f > properties.maxFrequency)
+            return false;
+        return true;
+    }
+
+    SpectrumFramePool::SpectrumFramePool(size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            frames.push_back(std::make_shared<SpectrumFrame>());
+    }
+
+    std::shared_ptr<SpectrumFrame> SpectrumFramePool::acquire()
+    {
+        for (size_t i = 0; i < frames.size(); ++i) {
+            std::shared_ptr<SpectrumFrame> &frame = frames[(next + i) % frames.size()];
+
+            // Only the pool holds it, nobody can take a new reference.
+            if (frame.use_count() == 1) {
+                // Pairs with the release of the last consumer reference.
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                next = (next + i + 1) % frames.size();
+                return frame;
+            }
+        }
+
+        return nullptr;
+    }
+
+    size_t SpectrumFramePool::size()
+    {
+        return frames.size();
+    }
+
+}
@@ -0,0 +1,103 @@
+/**
+ * Immutable snapshot of one calculated spectrum.
+ *
+ * A frame holds everything needed to display a spectrum (magnitude,
+ * real/imaginary part, the effective input samples, peak and the FFT
+ * properties), so consumers do not have to call back into the FFT.
+ * Consumers get a SpectrumFramePtr (pointer to const) and can keep it
+ * as long as they like, while the next frame is calculated.
+ *
+ * Frames are recycled by a SpectrumFramePool: A frame is only reused
+ * when no consumer holds it anymore. The vectors keep their capacity,
+ * so producing a frame does not allocate (after the first frames or
+ * a change of the FFT size).
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef SPECTRUM_FRAME_H
+#define SPECTRUM_FRAME_H
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "FFT.h"
+#include "SensorProtocol.h"
+
+// Triple buffering (writing, pending, displayed) plus queued frames.
+#define DEFAULT_SPECTRUM_FRAME_POOL_SIZE 3
+
+namespace hrm
+{
+
+    struct SpectrumFrame {
+        uint64_t sequence = 0;
+
+        // Statistics::now() of the serial read that completed the
+        // spectrum and of the peak detection (0 if not measured)
+        uint64_t receiveTime = 0;
+        uint64_t peakTime = 0;
+
+        // Vector index i-1 is frequency bin i (see FFT).
+        std::vector<double> magnitude;
+        std::vector<double> real;
+        std::vector<double> imaginary;
+        std::vector<double> input; // Effective samples
+        Peak peak;
+        FFT_properties properties;
+
+        // Only with several FFT channels (SENSOR_CHANNEL order), else
+        // empty.
+        std::vector<Peak> channelPeaks;
+        Peak combinedPeak;
+        double ratio = 0.0; // Broadband / IR at the combined peak
+
+        // Only if the FFT uses the autocorrelation (channel 0), else
+        // lag -1.
+        AutocorrelationPeak autocorrelationPeak;
+
+        /**
+         * Copies the current result of the FFT (channel 0) and the
+         * peaks of the other channels.
+         */
+        void assign(FFT &fft, const Peak &peak);
+
+        // Like the FFT methods, but from the properties of this frame.
+        double indexToFrequency(double i) const;
+        bool isRequiredFrequency(int index) const;
+    };
+
+    typedef std::shared_ptr<const SpectrumFrame> SpectrumFramePtr;
+
+    /**
+     * Fixed set of frames for one producer. Consumers release a frame
+     * by dropping their pointer (from any thread).
+     */
+    class SpectrumFramePool
+    {
+        private:
+            std::vector<std::shared_ptr<SpectrumFrame>> frames;
+            size_t next = 0;
+
+        public:
+            SpectrumFramePool(size_t size = DEFAULT_SPECTRUM_FRAME_POOL_SIZE);
+
+            SpectrumFramePool(const SpectrumFramePool &) = delete;
+            SpectrumFramePool &operator=(const SpectrumFramePool &) = delete;
+
+            /**
+             * Producer only.
+             *
+             * @return A frame nobody else holds (to be filled), nullptr
+             * if all frames are in use.
+             */
+            std::shared_ptr<SpectrumFrame> acquire();
+
+            size_t size();
+    };
+
+}
+
+#endif
@@ -0,0 +1,221 @@
+#include "Statistics.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+namespace hrm
+{
+
+    LatencyHistogram::LatencyHistogram()
+    {
+        reset();
+    }
+
+    int LatencyHistogram::bucketIndex(uint64_t value)
+    {
+        if (value < LATENCY_SUB_BUCKETS)
+            return value;
+
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - LATENCY_SUB_BUCKET_BITS;
+
+        return (shift + 1) * LATENCY_SUB_BUCKETS +
+               ((value >> shift) & (LATENCY_SUB_BUCKETS - 1));
+    }
+
+    uint64_t LatencyHistogram::bucketValue(int index)
+    {
+        if (index < LATENCY_SUB_BUCKETS)
+            return index;
+
+        int shift = index / LATENCY_SUB_BUCKETS - 1;
+        uint64_t sub = index % LATENCY_SUB_BUCKETS;
+
+        // Upper bound
+        return ((LATENCY_SUB_BUCKETS + sub) << shift) + ((uint64_t) 1 << shift) - 1;
+    }
+
+    void LatencyHistogram::record(uint64_t value)
+    {
+        buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current = max.load(std::memory_order_relaxed);
+        while (value > current &&
+                !max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+
+    void LatencyHistogram::reset()
+    {
+        for (int i = 0; i < LATENCY_BUCKETS; ++i)
+            buckets[i].store(0, std::memory_order_relaxed);
+
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::getCount()
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::getMax()
+    {
+        return max.load(std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::getMean()
+    {
+        uint64_t n = getCount();
+        if (n == 0)
+            return 0.0;
+        return sum.load(std::memory_order_relaxed) / (double) n;
+    }
+
+    uint64_t LatencyHistogram::getPercentile(double percentile)
+    {
+        // The buckets may change while reading, use their own total.
+        uint64_t total = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i)
+            total += buckets[i].load(std::memory_order_relaxed);
+
+        if (total == 0)
+            return 0;
+
+        uint64_t rank = (uint64_t)(percentile / 100.0 * total + 0.5);
+        if (rank < 1)
+            rank = 1;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(bucketValue(i), getMax());
+        }
+
+        return getMax();
+    }
+
+    Statistics::Statistics()
+    {
+        reset();
+    }
+
+    LatencyHistogram &Statistics::getHistogram(STAGE stage)
+    {
+        return histograms[stage];
+    }
+
+    uint64_t Statistics::get(COUNTER counter)
+    {
+        return counters[counter].load(std::memory_order_relaxed);
+    }
+
+    uint64_t Statistics::get(GAUGE gauge)
+    {
+        return gauges[gauge].load(std::memory_order_relaxed);
+    }
+
+    void Statistics::reset()
+    {
+        for (int i = 0; i < STAGE_COUNT; ++i)
+            histograms[i].reset();
+        for (int i = 0; i < COUNTER_COUNT; ++i)
+            counters[i].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < GAUGE_COUNT; ++i)
+            gauges[i].store(0, std::memory_order_relaxed);
+    }
+
+    StatisticsSnapshot Statistics::snapshot()
+    {
+        StatisticsSnapshot snapshot;
+
+        snapshot.time = now();
+        for (int i = 0; i < COUNTER_COUNT; ++i)
+            snapshot.counters[i] = get((COUNTER) i);
+
+        return snapshot;
+    }
+
+    std::string Statistics::report(const StatisticsSnapshot &previous)
+    {
+        StatisticsSnapshot current = snapshot();
+        double seconds = (current.time - previous.time) / 1e9;
+        std::string text;
+        char line[160];
+
+#ifndef HRM_STATISTICS
+        text += "Compiled without HRM_STATISTICS, nothing is recorded.\n\n";
+#endif
+
+        snprintf(line, sizeof(line), "%-10s %10s %10s %10s %10s %10s %10s\n",
+                 "Stage (us)", "count", "mean", "p50", "p99", "p99.9", "max");
+        text += line;
+
+        for (int i = 0; i < STAGE_COUNT; ++i) {
+            LatencyHistogram &histogram = histograms[i];
+
+            snprintf(line, sizeof(line),
+                     "%-10s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                     stageName((STAGE) i),
+                     (unsigned long long) histogram.getCount(),
+                     histogram.getMean() / 1e3,
+                     histogram.getPercentile(50) / 1e3,
+                     histogram.getPercentile(99) / 1e3,
+                     histogram.getPercentile(99.9) / 1e3,
+                     histogram.getMax() / 1e3);
+            text += line;
+        }
+
+        snprintf(line, sizeof(line), "\n%-18s %12s %10s\n", "Counter", "total", "per s");
+        text += line;
+
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            // After reset() the counters may be lower than before.
+            uint64_t delta = current.counters[i] >= previous.counters[i] ?
+                             current.counters[i] - previous.counters[i] : 0;
+            double rate = seconds > 0.0 ? delta / seconds : 0.0;
+
+            snprintf(line, sizeof(line), "%-18s %12llu %10.1f\n",
+                     counterName((COUNTER) i),
+                     (unsigned long long) current.counters[i], rate);
+            text += line;
+        }
+
+        snprintf(line, sizeof(line), "\n%-18s %12s\n", "Queue", "depth");
+        text += line;
+
+        for (int i = 0; i < GAUGE_COUNT; ++i) {
+            snprintf(line, sizeof(line), "%-18s %12llu\n", gaugeName((GAUGE) i),
+                     (unsigned long long) get((GAUGE) i));
+            text += line;
+        }
+
+        return text;
+    }
+
+    const char *Statistics::stageName(STAGE stage)
+    {
+        static const char *names[] = {"parse", "buffer", "fft", "peak", "display", "total"};
+        return names[stage];
+    }
+
+    const char *Statistics::counterName(COUNTER counter)
+    {
+        static const char *names[] = {"samples", "spectra", "lines", "malformed lines",
+                                      "frames", "crc errors", "dropped samples",
+                                      "dropped spectra"
+                                     };
+        return names[counter];
+    }
+
+    const char *Statistics::gaugeName(GAUGE gauge)
+    {
+        static const char *names[] = {"samples", "spectra"};
+        return names[gauge];
+    }
+
+}
@@ -0,0 +1,180 @@
+/**
+ * Latency histograms and counters of the processing stages.
+ *
+ * Timestamps are taken with a monotonic clock (ns) at the stage
+ * boundaries of one spectrum:
+ *
+ *   serial receive -> parsed -> buffer full -> FFT done -> peak found
+ *   -> displayed
+ *
+ * LatencyHistogram is log-linear (HDR style): Each power of two is
+ * split into LATENCY_SUB_BUCKETS buckets, so the relative error is
+ * below 1/16 for any value. Recording is one relaxed atomic add per
+ * value, readers (the statistics tab) never block the writers.
+ *
+ * Without HRM_STATISTICS (see CMakeLists.txt) now() returns 0 and
+ * nothing is recorded.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// 2^LATENCY_SUB_BUCKET_BITS buckets per power of two
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+namespace hrm
+{
+
+    enum STAGE {
+        STAGE_PARSE,    // Serial receive -> samples parsed
+        STAGE_BUFFER,   // Serial receive -> FFT buffer full
+        STAGE_FFT,      // Buffer full -> spectrum calculated
+        STAGE_PEAK,     // Spectrum calculated -> peak found
+        STAGE_DISPLAY,  // Peak found -> painted by the GUI
+        STAGE_TOTAL,    // Serial receive -> painted by the GUI
+        STAGE_COUNT
+    };
+
+    enum COUNTER {
+        COUNTER_SAMPLES,
+        COUNTER_SPECTRA,
+        COUNTER_LINES,
+        COUNTER_MALFORMED_LINES,
+        COUNTER_FRAMES,
+        COUNTER_CRC_ERRORS,
+        COUNTER_DROPPED_SAMPLES,
+        COUNTER_DROPPED_SPECTRA,
+        COUNTER_COUNT
+    };
+
+    // Current values, not accumulated.
+    enum GAUGE {
+        GAUGE_SAMPLE_QUEUE,
+        GAUGE_SPECTRUM_QUEUE,
+        GAUGE_COUNT
+    };
+
+    class LatencyHistogram
+    {
+        private:
+            std::atomic<uint64_t> buckets[LATENCY_BUCKETS];
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> sum;
+            std::atomic<uint64_t> max;
+
+            static int bucketIndex(uint64_t value);
+            static uint64_t bucketValue(int index);
+
+        public:
+            LatencyHistogram();
+
+            LatencyHistogram(const LatencyHistogram &) = delete;
+            LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+            // Any thread
+            void record(uint64_t value);
+            void reset();
+
+            uint64_t getCount();
+            uint64_t getMax();
+            double getMean();
+
+            /**
+             * @param percentile 0 - 100
+             * @return Upper bound of the bucket holding the percentile, 0
+             * if nothing was recorded.
+             */
+            uint64_t getPercentile(double percentile);
+    };
+
+    struct StatisticsSnapshot {
+        uint64_t time = 0; // ns
+        uint64_t counters[COUNTER_COUNT] = {};
+    };
+
+    class Statistics
+    {
+        private:
+            LatencyHistogram histograms[STAGE_COUNT];
+            std::atomic<uint64_t> counters[COUNTER_COUNT];
+            std::atomic<uint64_t> gauges[GAUGE_COUNT];
+
+        public:
+            Statistics();
+
+            Statistics(const Statistics &) = delete;
+            Statistics &operator=(const Statistics &) = delete;
+
+            /**
+             * @return Monotonic time in ns.
+             */
+            static uint64_t now() {
+#ifdef HRM_STATISTICS
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+                return 0;
+#endif
+            }
+
+            /**
+             * Records end - begin. Ignored if a timestamp is missing.
+             */
+            void record(STAGE stage, uint64_t begin, uint64_t end) {
+#ifdef HRM_STATISTICS
+                if (begin && end >= begin)
+                    histograms[stage].record(end - begin);
+#endif
+            }
+
+            void add(COUNTER counter, uint64_t value = 1) {
+#ifdef HRM_STATISTICS
+                counters[counter].fetch_add(value, std::memory_order_relaxed);
+#endif
+            }
+
+            // For counters kept elsewhere (e.g. LineStatistics).
+            void set(COUNTER counter, uint64_t value) {
+#ifdef HRM_STATISTICS
+                counters[counter].store(value, std::memory_order_relaxed);
+#endif
+            }
+
+            void set(GAUGE gauge, uint64_t value) {
+#ifdef HRM_STATISTICS
+                gauges[gauge].store(value, std::memory_order_relaxed);
+#endif
+            }
+
+            LatencyHistogram &getHistogram(STAGE stage);
+            uint64_t get(COUNTER counter);
+            uint64_t get(GAUGE gauge);
+
+            void reset();
+
+            StatisticsSnapshot snapshot();
+
+            /**
+             * Text table of the histograms (us), counters and gauges.
+             * Rates are calculated since the previous snapshot.
+             */
+            std::string report(const StatisticsSnapshot &previous);
+
+            static const char *stageName(STAGE stage);
+            static const char *counterName(COUNTER counter);
+            static const char *gaugeName(GAUGE gauge);
+    };
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#include "Trace.h"
+
+namespace hrm
+{
+
+    // Index of the calling worker, -1 outside of a pool
+    static thread_local int workerIndex = -1;
+    static thread_local ThreadPool *workerPool = nullptr;
+
+    ThreadPool::ThreadPool(int threads) : queued(0), pending(0), nextWorker(0)
+    {
+        if (threads <= 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (int i = 0; i < threads; ++i)
+            workers.push_back(std::unique_ptr<Worker>(new Worker()));
+
+        // All queues exist before a worker may steal.
+        for (int i = 0; i < threads; ++i)
+            workers[i]->thread = std::thread(&ThreadPool::run, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskCondition.notify_all();
+
+        for (auto &worker : workers)
+            worker->thread.join();
+    }
+
+    void ThreadPool::submit(Task task)
+    {
+        int index;
+        if (workerPool == this)
+            index = workerIndex;
+        else
+            index = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+        pending.fetch_add(1);
+
+        {
+            std::lock_guard<std::mutex> lock(workers[index]->mutex);
+            workers[index]->tasks.push_back(std::move(task));
+        }
+
+        {
+            // Under the lock, so a worker going to sleep sees it.
+            std::lock_guard<std::mutex> lock(mutex);
+            queued.fetch_add(1);
+        }
+        taskCondition.notify_one();
+    }
+
+    bool ThreadPool::pop(int index, Task &task)
+    {
+        Worker &worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        if (worker.tasks.empty())
+            return false;
+
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool ThreadPool::steal(int index, Task &task)
+    {
+        int count = workers.size();
+
+        for (int i = 1; i < count; ++i) {
+            Worker &worker = *workers[(index + i) % count];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+
+            if (worker.tasks.empty())
+                continue;
+
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            return true;
+        }
+
+        return false;
+    }
+
+    void ThreadPool::run(int index)
+    {
+        workerIndex = index;
+        workerPool = this;
+        Trace::instance().setThreadName("Thread pool");
+
+        while (true) {
+            Task task;
+
+            if (pop(index, task) || steal(index, task)) {
+                queued.fetch_sub(1);
+                task();
+                task = nullptr;
+
+                if (pending.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    doneCondition.notify_all();
+                }
+
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            taskCondition.wait(lock, [this] {
+                return stopping || queued.load() > 0;
+            });
+
+            if (stopping && queued.load() == 0)
+                return;
+        }
+    }
+
+    void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [this] {
+            return pending.load() == 0;
+        });
+    }
+
+    int ThreadPool::getThreadCount()
+    {
+        return workers.size();
+    }
+
+}
@@ -0,0 +1,87 @@
+/**
+ * Fixed size pool of worker threads with work stealing.
+ *
+ * Every worker has its own task queue. A worker takes the newest task
+ * of its own queue (LIFO, warm caches) and steals the oldest task of
+ * the other queues when its own is empty. Tasks submitted from outside
+ * the pool are distributed round-robin, tasks submitted by a worker go
+ * to its own queue.
+ *
+ * Tasks must not block on each other. The destructor runs the queued
+ * tasks before the workers are joined.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hrm
+{
+
+    class ThreadPool
+    {
+        public:
+            typedef std::function<void()> Task;
+
+        private:
+            struct Worker {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+                std::thread thread;
+            };
+
+            std::vector<std::unique_ptr<Worker>> workers;
+
+            // Idle workers and wait() sleep on it.
+            std::mutex mutex;
+            std::condition_variable taskCondition;
+            std::condition_variable doneCondition;
+            bool stopping = false;
+
+            // Tasks in the queues
+            std::atomic<uint64_t> queued;
+            // Tasks in the queues or running
+            std::atomic<uint64_t> pending;
+
+            std::atomic<unsigned int> nextWorker;
+
+            void run(int index);
+            bool pop(int index, Task &task);
+            bool steal(int index, Task &task);
+
+        public:
+            /**
+             * @param threads Number of workers, 0 for one per core.
+             */
+            ThreadPool(int threads = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool &) = delete;
+            ThreadPool &operator=(const ThreadPool &) = delete;
+
+            void submit(Task task);
+
+            /**
+             * Blocks until all submitted tasks (and the tasks they
+             * submitted) are done. Not from a worker.
+             */
+            void wait();
+
+            int getThreadCount();
+    };
+
+}
+
+#endif
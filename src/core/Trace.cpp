@@ -0,0 +1,155 @@
+#include "Trace.h"
+
+#include <chrono>
+
+namespace hrm
+{
+
+    // Buffer of the calling thread (registered on its first span)
+    static thread_local TraceBuffer *currentBuffer = nullptr;
+    static thread_local const char *currentThreadName = nullptr;
+
+    Trace::Trace() : enabled(false)
+    {
+    }
+
+    Trace &Trace::instance()
+    {
+        static Trace trace;
+        return trace;
+    }
+
+    uint64_t Trace::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    TraceBuffer *Trace::registerThread()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        TraceBuffer *buffer = new TraceBuffer();
+        buffer->threadId = buffers.size() + 1;
+        buffer->threadName = currentThreadName ? currentThreadName :
+                             "thread " + std::to_string(buffer->threadId);
+        buffers.push_back(std::unique_ptr<TraceBuffer>(buffer));
+
+        return buffer;
+    }
+
+    TraceBuffer *Trace::threadBuffer()
+    {
+        if (!currentBuffer)
+            currentBuffer = registerThread();
+        return currentBuffer;
+    }
+
+    void Trace::start()
+    {
+        if (isEnabled())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &buffer : buffers)
+                buffer->position.store(0, std::memory_order_relaxed);
+        }
+
+        enabled.store(true, std::memory_order_release);
+    }
+
+    void Trace::stop()
+    {
+        enabled.store(false, std::memory_order_release);
+    }
+
+    void Trace::setThreadName(const char *name)
+    {
+        currentThreadName = name;
+
+        if (currentBuffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            currentBuffer->threadName = name;
+        }
+    }
+
+    void Trace::add(const char *name, uint64_t begin, uint64_t end)
+    {
+        // Span started before stop()
+        if (!isEnabled())
+            return;
+
+        TraceBuffer *buffer = threadBuffer();
+        uint64_t position = buffer->position.load(std::memory_order_relaxed);
+        TraceEvent &event = buffer->events[position % TRACE_BUFFER_SIZE];
+
+        event.name.store(name, std::memory_order_relaxed);
+        event.begin.store(begin, std::memory_order_relaxed);
+        event.end.store(end, std::memory_order_relaxed);
+
+        buffer->position.store(position + 1, std::memory_order_release);
+    }
+
+    bool Trace::writeJSON(FILE *file)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Timestamps relative to the first span
+        uint64_t origin = UINT64_MAX;
+        for (auto &buffer : buffers) {
+            uint64_t position = buffer->position.load(std::memory_order_acquire);
+            uint64_t first = position > TRACE_BUFFER_SIZE ? position - TRACE_BUFFER_SIZE : 0;
+
+            for (uint64_t i = first; i < position; ++i) {
+                uint64_t begin = buffer->events[i % TRACE_BUFFER_SIZE].begin.load(
+                                     std::memory_order_relaxed);
+                if (begin < origin)
+                    origin = begin;
+            }
+        }
+
+        fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+        bool firstEvent = true;
+        for (auto &buffer : buffers) {
+            fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+                    "\"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                    firstEvent ? "" : ",\n", buffer->threadId, buffer->threadName.c_str());
+            firstEvent = false;
+
+            uint64_t position = buffer->position.load(std::memory_order_acquire);
+            uint64_t first = position > TRACE_BUFFER_SIZE ? position - TRACE_BUFFER_SIZE : 0;
+
+            for (uint64_t i = first; i < position; ++i) {
+                TraceEvent &event = buffer->events[i % TRACE_BUFFER_SIZE];
+                uint64_t begin = event.begin.load(std::memory_order_relaxed);
+                uint64_t end = event.end.load(std::memory_order_relaxed);
+                const char *name = event.name.load(std::memory_order_relaxed);
+
+                if (!name || end < begin || begin < origin)
+                    continue;
+
+                // Complete event, times in us
+                fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                        "\"ts\": %.3f, \"dur\": %.3f}",
+                        name, buffer->threadId,
+                        (begin - origin) / 1e3, (end - begin) / 1e3);
+            }
+        }
+
+        fprintf(file, "\n]}\n");
+        return !ferror(file);
+    }
+
+    bool Trace::writeJSON(const std::string &fileName)
+    {
+        FILE *file = fopen(fileName.c_str(), "w");
+        if (!file)
+            return false;
+
+        bool status = writeJSON(file);
+        return fclose(file) == 0 && status;
+    }
+
+}
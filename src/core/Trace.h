@@ -0,0 +1,139 @@
+/**
+ * Span tracing of single calls, exported as Chrome trace-event JSON
+ * (load the file in Perfetto or chrome://tracing).
+ *
+ *   void Serial::receiveData()
+ *   {
+ *       TRACE_SCOPE("Serial::receiveData");
+ *       ...
+ *   }
+ *
+ * Each thread writes its spans into its own ring buffer (no locks, the
+ * oldest spans are overwritten), so the spans of the last
+ * TRACE_BUFFER_SIZE calls per thread are kept. Names have to be string
+ * literals.
+ *
+ * Tracing is off until start(). While off, a span costs one relaxed
+ * load. Without HRM_TRACE (see CMakeLists.txt) TRACE_SCOPE is empty.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define TRACE_BUFFER_SIZE 65536 // Spans per thread
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef HRM_TRACE
+#define TRACE_SCOPE(name) hrm::TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
+
+namespace hrm
+{
+
+    // Fields are atomic, so exporting while a thread writes can only
+    // produce a wrong span, never an invalid name.
+    struct TraceEvent {
+        std::atomic<const char *> name;
+        std::atomic<uint64_t> begin; // ns
+        std::atomic<uint64_t> end;
+    };
+
+    struct TraceBuffer {
+        int threadId = 0;
+        std::string threadName;
+
+        std::unique_ptr<TraceEvent[]> events;
+        // Written by the owning thread only.
+        std::atomic<uint64_t> position;
+
+        TraceBuffer() : events(new TraceEvent[TRACE_BUFFER_SIZE]), position(0) {}
+    };
+
+    class Trace
+    {
+        private:
+            std::atomic<bool> enabled;
+
+            std::mutex mutex;
+            // Kept after the thread exited, so its spans are exported.
+            std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+            Trace();
+
+            TraceBuffer *registerThread();
+            TraceBuffer *threadBuffer();
+
+        public:
+            Trace(const Trace &) = delete;
+            Trace &operator=(const Trace &) = delete;
+
+            static Trace &instance();
+
+            /**
+             * @return Monotonic time in ns.
+             */
+            static uint64_t now();
+
+            bool isEnabled() {
+                return enabled.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Clears the buffers and starts recording.
+             */
+            void start();
+            void stop();
+
+            /**
+             * Name of the calling thread in the trace (string literal).
+             * Does not allocate the buffer of the thread.
+             */
+            void setThreadName(const char *name);
+
+            void add(const char *name, uint64_t begin, uint64_t end);
+
+            /**
+             * Writes the recorded spans of all threads. Stop tracing
+             * before, otherwise spans written meanwhile may be wrong.
+             */
+            bool writeJSON(FILE *file);
+            bool writeJSON(const std::string &fileName);
+    };
+
+    class TraceSpan
+    {
+        private:
+            const char *name;
+            uint64_t begin;
+
+        public:
+            TraceSpan(const char *name) :
+                name(name), begin(Trace::instance().isEnabled() ? Trace::now() : 0) {}
+
+            ~TraceSpan() {
+                if (begin)
+                    Trace::instance().add(name, begin, Trace::now());
+            }
+
+            TraceSpan(const TraceSpan &) = delete;
+            TraceSpan &operator=(const TraceSpan &) = delete;
+    };
+
+}
+
+#endif
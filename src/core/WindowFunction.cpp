@@ -0,0 +1,105 @@
+#include "WindowFunction.h"
+
+#include <cmath>
+#include <numeric>
+
+#ifdef _WIN32
+const static double M_PI = 3.14159265359;
+#endif
+
+namespace hrm
+{
+
+    const WindowTable &WindowFunction::get(WINDOW_TYPE type, int length, double beta)
+    {
+        if (type != KAISER)
+            beta = 0.0;
+
+        auto key = std::make_tuple((int) type, length, beta);
+        auto it = cache.find(key);
+
+        if (it == cache.end())
+            it = cache.insert(std::make_pair(key, calculate(type, length, beta))).first;
+
+        return it->second;
+    }
+
+    void WindowFunction::clear()
+    {
+        cache.clear();
+    }
+
+    WindowTable WindowFunction::calculate(WINDOW_TYPE type, int length, double beta)
+    {
+        WindowTable table;
+        table.coefficients.resize(length);
+
+        // Generalized cosine windows: a0 - a1*cos(x) + a2*cos(2x) - ...
+        std::vector<double> a;
+
+        switch (type) {
+        case HAMMING:
+            a = {0.54, 0.46};
+            break;
+        case HANN:
+            a = {0.5, 0.5};
+            break;
+        case BLACKMAN:
+            a = {0.42, 0.5, 0.08};
+            break;
+        case BLACKMAN_HARRIS:
+            a = {0.35875, 0.48829, 0.14128, 0.01168};
+            break;
+        case FLAT_TOP:
+            a = {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368};
+            break;
+        case KAISER:
+            break;
+        }
+
+        for (int i = 0; i < length; ++i) {
+            double value = 0.0;
+
+            if (type == KAISER) {
+                double r = 2.0 * i / length - 1.0;
+                value = besselI0(beta * sqrt(1.0 - r * r)) / besselI0(beta);
+            } else {
+                double x = (2 * M_PI * i) / length;
+                double sign = 1.0;
+
+                for (unsigned int k = 0; k < a.size(); ++k) {
+                    value += sign * a[k] * cos(k * x);
+                    sign = -sign;
+                }
+            }
+
+            table.coefficients[i] = value;
+        }
+
+        if (length > 0)
+            table.coherentGain = std::accumulate(table.coefficients.begin(),
+                                                 table.coefficients.end(), 0.0) / length;
+
+        return table;
+    }
+
+    double WindowFunction::besselI0(double x)
+    {
+        // Power series: sum ((x/2)^k / k!)^2
+        double sum = 1.0;
+        double term = 1.0;
+        double halfX = x / 2.0;
+
+        for (int k = 1; k < 50; ++k) {
+            term *= halfX / k;
+            double t = term * term;
+            sum += t;
+
+            if (t < sum * 1e-16)
+                break;
+        }
+
+        return sum;
+    }
+
+}
@@ -0,0 +1,61 @@
+/**
+ * Window functions for the time domain input signal (to weaken the
+ * leakage effect).
+ *
+ * The coefficient tables are computed once per (type, length) and
+ * cached, so applying a window is a single multiplication pass over
+ * the frame.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef WINDOW_FUNCTION_H
+#define WINDOW_FUNCTION_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#define DEFAULT_KAISER_BETA 8.6
+
+namespace hrm
+{
+
+    enum WINDOW_TYPE {HAMMING, HANN, BLACKMAN, BLACKMAN_HARRIS, KAISER, FLAT_TOP};
+
+    struct WindowTable {
+        std::vector<double> coefficients;
+
+        // Mean of the coefficients. A sinusoid multiplied with the window
+        // has its amplitude scaled by this value.
+        double coherentGain = 1.0;
+    };
+
+    class WindowFunction
+    {
+        private:
+            // (type, length, beta) => table. Beta is only used for KAISER.
+            std::map<std::tuple<int, int, double>, WindowTable> cache;
+
+            static WindowTable calculate(WINDOW_TYPE type, int length, double beta);
+
+            /**
+             * Modified Bessel function of the first kind, order 0 (for
+             * the Kaiser window).
+             */
+            static double besselI0(double x);
+
+        public:
+            /**
+             * @return The cached coefficient table. It is calculated on
+             * the first request.
+             */
+            const WindowTable &get(WINDOW_TYPE type, int length,
+                                   double beta = DEFAULT_KAISER_BETA);
+
+            void clear();
+    };
+
+}
+
+#endif
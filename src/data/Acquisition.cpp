@@ -0,0 +1,330 @@
+#include "Acquisition.h"
+
+namespace hrm
+{
+
+    Acquisition::Acquisition(QObject *parent) :
+        QObject(parent),
+        sampleQueue(ACQUISITION_SAMPLE_QUEUE_SIZE),
+        spectrumQueue(ACQUISITION_SPECTRUM_QUEUE_SIZE),
+        beatQueue(ACQUISITION_BEAT_QUEUE_SIZE),
+        framePool(ACQUISITION_SPECTRUM_QUEUE_SIZE + 2),
+        notified(false),
+        droppedSamples(0),
+        droppedSpectra(0)
+    {
+        // Child, so it is moved to the acquisition thread as well.
+        serial = new Serial(this);
+
+        replayTimer = new QTimer(this);
+        connect(replayTimer, SIGNAL(timeout()), this, SLOT(replayTimeout()));
+
+        // Direct: the block is only valid during the emit (see Serial.h).
+        connect(serial, SIGNAL(receiveSensorDataBlock(const SensorData *, int)),
+                this, SLOT(receiveSensorDataBlock(const SensorData *, int)),
+                Qt::DirectConnection);
+        connect(serial, SIGNAL(receiveSensorSettings(SensorSettings)),
+                this, SLOT(receiveSensorSettings(SensorSettings)));
+        connect(serial, SIGNAL(criticalError(QString)),
+                this, SIGNAL(criticalError(QString)));
+    }
+
+    Acquisition::~Acquisition()
+    {
+    }
+
+    void Acquisition::receiveSensorDataBlock(const SensorData *data, int count)
+    {
+        processBlock(data, count, serial->getReceiveTime());
+    }
+
+    void Acquisition::processBlock(const SensorData *data, int count, uint64_t receiveTime)
+    {
+        TRACE_SCOPE("Acquisition::processBlock");
+
+        statistics.record(STAGE_PARSE, receiveTime, Statistics::now());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!pipeline) {
+                sendData(QString::fromStdString(SensorProtocol::GET_SETTINGS) + '\n');
+                return;
+            }
+
+            if (recorder.isOpen())
+                recorder.add(data, count);
+
+            blockReceiveTime = receiveTime;
+
+            for (int i = 0; i < count; ++i) {
+                // Calls pushSpectrum.
+                pipeline->push(data[i]);
+
+                if (!sampleQueue.push(data[i]))
+                    ++droppedSamples;
+            }
+        }
+
+        statistics.add(COUNTER_SAMPLES, count);
+        updateStatistics();
+
+        notify();
+    }
+
+    void Acquisition::updateStatistics()
+    {
+        const LineStatistics &lines = serial->getLineStatistics();
+        const FrameStatistics &frames = serial->getFrameStatistics();
+
+        // Copied, the parser statistics are not atomic.
+        statistics.set(COUNTER_LINES, lines.lines);
+        statistics.set(COUNTER_MALFORMED_LINES, lines.malformedLines);
+        statistics.set(COUNTER_FRAMES, frames.frames);
+        statistics.set(COUNTER_CRC_ERRORS, frames.crcErrors);
+        statistics.set(COUNTER_DROPPED_SAMPLES, droppedSamples.load());
+        statistics.set(COUNTER_DROPPED_SPECTRA, droppedSpectra.load());
+
+        statistics.set(GAUGE_SAMPLE_QUEUE, sampleQueue.size());
+        statistics.set(GAUGE_SPECTRUM_QUEUE, spectrumQueue.size());
+    }
+
+    void Acquisition::threadStarted()
+    {
+        Trace::instance().setThreadName("Acquisition");
+    }
+
+    void Acquisition::receiveSensorSettings(SensorSettings settings)
+    {
+        double sampleInterval = QString::fromStdString(settings.sampleInterval).toDouble();
+        FFT_properties properties;
+
+        this->settings = settings;
+        this->sampleInterval = sampleInterval;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!pipeline) {
+                pipeline = std::unique_ptr<Pipeline>(new Pipeline(sampleInterval));
+                pipeline->setSpectrumCallback([this](FFT & fft, const Peak & peak) {
+                    pushSpectrum(fft, peak);
+                });
+                pipeline->setBeatCallback([this](const Beat & beat) {
+                    beatQueue.push(beat);
+                });
+                pipeline->setUseBeatDetector(useBeatDetector);
+                pipeline->getFFT().setDeterministic(replaying);
+                pipeline->getFFT().setSettings(fftSettings);
+            } else {
+                pipeline->setSampleInterval(sampleInterval);
+            }
+
+            properties = pipeline->getFFT().getProperties();
+        }
+
+        Q_EMIT sensorSettings(settings, properties);
+    }
+
+    void Acquisition::pushSpectrum(FFT &fft, const Peak &peak)
+    {
+        const PipelineTiming &timing = pipeline->getTiming();
+
+        statistics.record(STAGE_BUFFER, blockReceiveTime, timing.bufferFull);
+        statistics.record(STAGE_FFT, timing.bufferFull, timing.fftDone);
+        statistics.record(STAGE_PEAK, timing.fftDone, timing.peakFound);
+        statistics.add(COUNTER_SPECTRA);
+
+        std::shared_ptr<SpectrumFrame> frame = framePool.acquire();
+        if (!frame) {
+            ++droppedSpectra;
+            return;
+        }
+
+        frame->assign(fft, peak);
+        frame->sequence = frameSequence++;
+        frame->receiveTime = blockReceiveTime;
+        frame->peakTime = timing.peakFound;
+
+        if (!spectrumQueue.push(frame))
+            ++droppedSpectra;
+    }
+
+    void Acquisition::notify()
+    {
+        if (!notified.exchange(true))
+            Q_EMIT dataAvailable();
+    }
+
+    void Acquisition::acknowledge()
+    {
+        notified.store(false);
+    }
+
+    bool Acquisition::openSerial()
+    {
+        stopReplay();
+        return serial->openSerial();
+    }
+
+    void Acquisition::closeSerial()
+    {
+        serial->closeSerial();
+    }
+
+    void Acquisition::sendData(QString data)
+    {
+        serial->sendData(data);
+    }
+
+    void Acquisition::setBinaryMode(bool status)
+    {
+        serial->setBinaryMode(status);
+    }
+
+    bool Acquisition::startRecording(QString fileName)
+    {
+        if (!pipeline)
+            return false;
+
+        return recorder.open(fileName.toLocal8Bit().constData(),
+                             settings, sampleInterval);
+    }
+
+    bool Acquisition::stopRecording()
+    {
+        return recorder.close();
+    }
+
+    bool Acquisition::startReplay(QString fileName, bool realTime)
+    {
+        stopReplay();
+        serial->closeSerial();
+
+        if (!replay.open(fileName.toLocal8Bit().constData()))
+            return false;
+
+        replay.setPacing(realTime ? REPLAY_REAL_TIME : REPLAY_FAST);
+        replaying = true;
+
+        // Same start state and plans for every run (the new pipeline
+        // gets deterministic plans).
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pipeline.reset();
+        }
+
+        SensorSettings settings = replay.getSettings();
+        settings.sampleInterval = QString::number(replay.getSampleInterval()).toStdString();
+        receiveSensorSettings(settings);
+
+        replay.rewind();
+        replayTimer->start(realTime ? REPLAY_TIMER_INTERVAL : 0);
+
+        return true;
+    }
+
+    void Acquisition::stopReplay()
+    {
+        if (!replaying)
+            return;
+
+        replayTimer->stop();
+        replay.close();
+        replaying = false;
+
+        // The replay pipeline only has deterministic plans, the next
+        // settings line creates one with measured plans.
+        std::lock_guard<std::mutex> lock(mutex);
+        pipeline.reset();
+    }
+
+    void Acquisition::replayTimeout()
+    {
+        TRACE_SCOPE("Acquisition::replayTimeout");
+
+        SensorData block[SERIAL_BLOCK_SIZE];
+
+        for (int i = 0; i < REPLAY_BLOCKS_PER_EVENT; ++i) {
+            uint64_t receiveTime = Statistics::now();
+
+            size_t count = replay.poll(block, SERIAL_BLOCK_SIZE);
+            if (count == 0)
+                break;
+
+            processBlock(block, count, receiveTime);
+        }
+
+        if (replay.atEnd()) {
+            stopReplay();
+            Q_EMIT replayFinished();
+        }
+    }
+
+    std::mutex &Acquisition::getMutex()
+    {
+        return mutex;
+    }
+
+    FFT *Acquisition::getFFT()
+    {
+        if (pipeline)
+            return &pipeline->getFFT();
+        return nullptr;
+    }
+
+    void Acquisition::updateFFTSettings(std::function<void(FFT_settings &settings)> function)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        function(fftSettings);
+
+        if (pipeline) {
+            FFT &fft = pipeline->getFFT();
+            fft.setSettings(fftSettings);
+            // As adjusted by the FFT, so the next change does not
+            // apply it again.
+            fftSettings = fft.getSettings();
+        }
+    }
+
+    void Acquisition::setUseBeatDetector(bool status)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        useBeatDetector = status;
+        if (pipeline)
+            pipeline->setUseBeatDetector(status);
+    }
+
+    SPSCQueue<SensorData> &Acquisition::getSampleQueue()
+    {
+        return sampleQueue;
+    }
+
+    SPSCQueue<SpectrumFramePtr> &Acquisition::getSpectrumQueue()
+    {
+        return spectrumQueue;
+    }
+
+    SPSCQueue<Beat> &Acquisition::getBeatQueue()
+    {
+        return beatQueue;
+    }
+
+    uint64_t Acquisition::getDroppedSamples()
+    {
+        return droppedSamples.load();
+    }
+
+    uint64_t Acquisition::getDroppedSpectra()
+    {
+        return droppedSpectra.load();
+    }
+
+    Statistics &Acquisition::getStatistics()
+    {
+        return statistics;
+    }
+
+}
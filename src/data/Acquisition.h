@@ -0,0 +1,208 @@
+/**
+ * Serial reader and signal processing on a dedicated thread.
+ *
+ * The object lives in its own QThread (see Controller). It owns the
+ * serial port and the pipeline, so reading and the FFT never wait for
+ * the GUI. Results are handed to the GUI thread through bounded
+ * lock-free SPSC queues, dataAvailable() is emitted (queued, at most
+ * once until the GUI drained the queues) when there is something new.
+ *
+ * Drop policy (acquisition never blocks on the GUI):
+ * - Every sample is processed by the pipeline, regardless of the GUI.
+ * - Samples for display: If the sample queue is full, new samples are
+ *   dropped (not displayed) and counted.
+ * - Spectra: If the spectrum queue is full or all frames of the pool
+ *   are held by consumers, the new spectrum is dropped and counted. The
+ *   GUI only displays the newest spectrum it drains.
+ * - Beats (if the beat detector is used): If the beat queue is full,
+ *   new beats are dropped.
+ *
+ * The raw samples can be recorded (see Recording.h), the file is
+ * written by the writer thread of RecordingWriter.
+ *
+ * Instead of the serial port, a recorded session can be the input
+ * (see Replay.h). The replay starts with a new pipeline and
+ * deterministic FFT plans, so its results do not depend on timing.
+ * After the replay, the pipeline is created again, so the live data
+ * gets measured plans.
+ *
+ * The latencies of the stages and the counters are recorded into
+ * getStatistics() (see Statistics.h), which can be read from any
+ * thread.
+ *
+ * FFT settings are changed from the GUI thread under the lock of
+ * getMutex(), which the acquisition thread holds while processing one
+ * block of samples. They are stored and applied to every new
+ * pipeline, so they also hold before the sensor settings are known
+ * and across replays.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "Pipeline.h"
+#include "Recording.h"
+#include "Replay.h"
+#include "SPSCQueue.h"
+#include "SpectrumFrame.h"
+#include "Serial.h"
+#include "Statistics.h"
+#include "Trace.h"
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#define ACQUISITION_SAMPLE_QUEUE_SIZE 4096
+#define ACQUISITION_SPECTRUM_QUEUE_SIZE 4
+#define ACQUISITION_BEAT_QUEUE_SIZE 64
+
+#define REPLAY_TIMER_INTERVAL 10 // ms (real time pacing)
+// Fast replay: Blocks per timer event, so commands are still processed.
+#define REPLAY_BLOCKS_PER_EVENT 16
+
+namespace hrm
+{
+
+    class Acquisition : public QObject
+    {
+            Q_OBJECT
+
+        private:
+            Serial *serial;
+            std::unique_ptr<Pipeline> pipeline;
+
+            RecordingWriter recorder;
+            // Last received settings (for the recording header)
+            SensorSettings settings;
+            double sampleInterval = 0.0;
+
+            Replay replay;
+            QTimer *replayTimer;
+            bool replaying = false;
+
+            std::mutex mutex;
+
+            SPSCQueue<SensorData> sampleQueue;
+            SPSCQueue<SpectrumFramePtr> spectrumQueue;
+            SPSCQueue<Beat> beatQueue;
+            // Queued frames, one held by the GUI, one being written.
+            SpectrumFramePool framePool;
+            uint64_t frameSequence = 0;
+            std::atomic<bool> notified;
+
+            std::atomic<uint64_t> droppedSamples;
+            std::atomic<uint64_t> droppedSpectra;
+
+            // Applied to new pipelines as well.
+            bool useBeatDetector = false;
+            FFT_settings fftSettings;
+
+            Statistics statistics;
+            // Statistics::now() of the block being processed
+            uint64_t blockReceiveTime = 0;
+
+            /**
+             * @param receiveTime Statistics::now() when the samples were
+             * read (serial port or replay).
+             */
+            void processBlock(const SensorData *data, int count, uint64_t receiveTime);
+            void updateStatistics();
+            void pushSpectrum(FFT &fft, const Peak &peak);
+            void notify();
+
+        private slots:
+            void receiveSensorDataBlock(const SensorData *data, int count);
+            void receiveSensorSettings(SensorSettings settings);
+            void replayTimeout();
+            void threadStarted();
+
+        public slots:
+            // Called via queued (or blocking queued) connections.
+            bool openSerial();
+            void closeSerial();
+            void sendData(QString data);
+            void setBinaryMode(bool status);
+
+            /**
+             * @retval false The settings of the sensor are not known yet
+             * or the file could not be created.
+             */
+            bool startRecording(QString fileName);
+            bool stopRecording();
+
+            /**
+             * Closes the serial port and feeds the samples of the file
+             * (binary recording or text log).
+             *
+             * @param realTime Otherwise as fast as possible.
+             */
+            bool startReplay(QString fileName, bool realTime);
+            void stopReplay();
+
+        signals:
+            void dataAvailable();
+            void sensorSettings(
+                SensorSettings settings,
+                FFT_properties properties);
+            void criticalError(QString message);
+            void replayFinished();
+
+        public:
+            Acquisition(QObject *parent = 0);
+            ~Acquisition();
+
+            /**
+             * Lock it to access getFFT() from another thread.
+             */
+            std::mutex &getMutex();
+
+            /**
+             * @return nullptr until the sensor settings are known.
+             */
+            FFT *getFFT();
+
+            /**
+             * Changes the stored FFT settings and applies them to the
+             * pipeline, if there is one. Can be called from any thread
+             * (locks getMutex()).
+             */
+            void updateFFTSettings(std::function<void(FFT_settings &settings)> function);
+
+            /**
+             * Runs the beat detector next to the FFT. Can be called from
+             * any thread (locks getMutex()).
+             */
+            void setUseBeatDetector(bool status);
+
+            // Consumer side (GUI thread)
+
+            /**
+             * Has to be called before draining the queues, otherwise new
+             * data is not notified again.
+             */
+            void acknowledge();
+
+            SPSCQueue<SensorData> &getSampleQueue();
+            SPSCQueue<SpectrumFramePtr> &getSpectrumQueue();
+            SPSCQueue<Beat> &getBeatQueue();
+
+            uint64_t getDroppedSamples();
+            uint64_t getDroppedSpectra();
+
+            // Any thread
+            Statistics &getStatistics();
+    };
+
+}
+
+#endif // ACQUISITION_H
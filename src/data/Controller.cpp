@@ -3,64 +3,174 @@
 namespace hrm
 {
 
-    const QString Controller::GET_SETTINGS_SERIAL = "get settings";
-    const QString Controller::SET_SAMPLE_INTERVAL_SERIAL = "set sampleInterval ";
-
     Controller::Controller()
     {
-        serial = new Serial();
+        qRegisterMetaType<SensorSettings>("SensorSettings");
+        qRegisterMetaType<FFT_properties>("FFT_properties");
+        qRegisterMetaType<SpectrumFramePtr>("SpectrumFramePtr");
+        qRegisterMetaType<Beat>("Beat");
+
+        acquisition = new Acquisition();
+        acquisition->moveToThread(&thread);
 
         initSignals();
+
+        thread.start();
     }
 
     void Controller::initSignals()
     {
-        connect(serial, SIGNAL(receiveSensorData(SensorData)),
-                this, SLOT(receiveSensorData(SensorData)));
-        connect(serial, SIGNAL(receiveSensorSettings(SensorSettings)),
-                this, SLOT(receiveSensorSettings(SensorSettings)));
+        // Runs on the acquisition thread.
+        connect(&thread, SIGNAL(started()),
+                acquisition, SLOT(threadStarted()));
+
+        // Queued (acquisition thread => GUI thread)
+        connect(acquisition, SIGNAL(dataAvailable()),
+                this, SLOT(dataAvailable()));
+        connect(acquisition, SIGNAL(sensorSettings(SensorSettings, FFT_properties)),
+                this, SIGNAL(sensorSettings(SensorSettings, FFT_properties)));
+        connect(acquisition, SIGNAL(criticalError(QString)),
+                this, SIGNAL(serialError(QString)));
+        connect(acquisition, SIGNAL(replayFinished()),
+                this, SIGNAL(replayFinished()));
     }
 
     Controller::~Controller()
     {
-        serial->closeSerial();
-        delete serial;
+        QMetaObject::invokeMethod(acquisition, "closeSerial",
+                                  Qt::BlockingQueuedConnection);
+        stopRecording();
+
+        thread.quit();
+        thread.wait();
+
+        delete acquisition;
     }
 
-    void Controller::receiveSensorData(SensorData data)
+    void Controller::dataAvailable()
     {
-        if (!fft) {
-            getSensorSettings();
-            return;
-        }
+        TRACE_SCOPE("Controller::dataAvailable");
+
+        // Data pushed from now on is notified again.
+        acquisition->acknowledge();
+
+        // One signal per notification, not per sample.
+        SPSCQueue<SensorData> &samples = acquisition->getSampleQueue();
+        QVector<SensorData> drained;
+        drained.reserve(samples.size());
+
+        SensorData data;
+        while (samples.pop(data))
+            drained.append(data);
+
+        if (!drained.isEmpty())
+            Q_EMIT sensorData(drained);
+
+        // Only the newest spectrum is displayed.
+        // Older frames go back to the pool here.
+        SPSCQueue<SpectrumFramePtr> &spectra = acquisition->getSpectrumQueue();
+        SpectrumFramePtr frame;
+        SpectrumFramePtr newest;
+        while (spectra.pop(frame))
+            newest = std::move(frame);
+
+        if (newest)
+            Q_EMIT frequencySpectrum(newest);
+
+        SPSCQueue<Beat> &beats = acquisition->getBeatQueue();
+        Beat detected;
+        while (beats.pop(detected))
+            Q_EMIT beat(detected);
+    }
 
-        if (fft->addSample(data.broadband))
-            Q_EMIT frequencySpectrum(fft->getMagnitude(),
-                                     fft->getPeak());
+    bool Controller::startRecording(QString fileName)
+    {
+        bool status = false;
+
+        QMetaObject::invokeMethod(acquisition, "startRecording",
+                                  Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(bool, status),
+                                  Q_ARG(QString, fileName));
 
-        Q_EMIT sensorData(data);
+        return status;
     }
 
-    void Controller::receiveSensorSettings(SensorSettings settings)
+    bool Controller::stopRecording()
     {
+        bool status = true;
+
+        // Returns after the file is complete.
+        QMetaObject::invokeMethod(acquisition, "stopRecording",
+                                  Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(bool, status));
+
+        return status;
+    }
+
+    bool Controller::startReplay(QString fileName, bool realTime)
+    {
+        bool status = false;
+
+        QMetaObject::invokeMethod(acquisition, "startReplay",
+                                  Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(bool, status),
+                                  Q_ARG(QString, fileName),
+                                  Q_ARG(bool, realTime));
+
+        return status;
+    }
+
+    Statistics &Controller::getStatistics()
+    {
+        return acquisition->getStatistics();
+    }
+
+    void Controller::spectrumDisplayed(uint64_t peakTime, uint64_t receiveTime)
+    {
+        Statistics &statistics = acquisition->getStatistics();
+        uint64_t now = Statistics::now();
+
+        statistics.record(STAGE_DISPLAY, peakTime, now);
+        statistics.record(STAGE_TOTAL, receiveTime, now);
+    }
+
+    void Controller::withFFT(std::function<void(FFT &fft)> function)
+    {
+        std::lock_guard<std::mutex> lock(acquisition->getMutex());
+
+        FFT *fft = acquisition->getFFT();
         if (!fft)
-            fft = std::unique_ptr<FFT>(new FFT(settings.sampleInterval.toDouble()));
-        else
-            fft->setSampleInterval(settings.sampleInterval.toDouble());
+            return;
 
-        FFT_properties properties = fft->getProperties();
+        function(*fft);
+    }
 
-        Q_EMIT sensorSettings(settings, properties);
+    void Controller::withFFTSettings(std::function<void(FFT_settings &settings)> function)
+    {
+        acquisition->updateFFTSettings(function);
     }
 
-    FFT_properties Controller::getFFTProperties()
+    bool Controller::getFFTProperties(FFT_properties &properties)
     {
-        return fft->getProperties();
+        bool status = false;
+
+        withFFT([&](FFT & fft) {
+            properties = fft.getProperties();
+            status = true;
+        });
+
+        return status;
     }
 
     bool Controller::start()
     {
-        if (serial->openSerial()) {
+        bool status = false;
+
+        QMetaObject::invokeMethod(acquisition, "openSerial",
+                                  Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(bool, status));
+
+        if (status) {
             getSensorSettings();
             return true;
         }
@@ -70,105 +180,127 @@ namespace hrm
 
     void Controller::stop()
     {
-        serial->closeSerial();
+        QMetaObject::invokeMethod(acquisition, "closeSerial",
+                                  Qt::QueuedConnection);
+        QMetaObject::invokeMethod(acquisition, "stopReplay",
+                                  Qt::QueuedConnection);
     }
 
     void Controller::getSensorSettings()
     {
-        QString data = GET_SETTINGS_SERIAL;
-        serial->sendData(data + '\n');
+        QString data = QString::fromStdString(SensorProtocol::GET_SETTINGS);
+        QMetaObject::invokeMethod(acquisition, "sendData", Qt::QueuedConnection,
+                                  Q_ARG(QString, data + '\n'));
     }
 
     void Controller::setSampleInterval(QString sampleInterval)
     {
-        QString data = SET_SAMPLE_INTERVAL_SERIAL + sampleInterval;
-        serial->sendData(data + "\n");
+        QString data = QString::fromStdString(SensorProtocol::SET_SAMPLE_INTERVAL) +
+                       sampleInterval;
+        QMetaObject::invokeMethod(acquisition, "sendData", Qt::QueuedConnection,
+                                  Q_ARG(QString, data + "\n"));
 
         getSensorSettings();
     }
 
-    std::vector<double>& Controller::getMagnitude()
+    void Controller::setBinaryProtocol(bool status)
     {
-        return fft->getMagnitude();
+        const std::string &command = status ? SensorProtocol::SET_PROTOCOL_BINARY
+                                     : SensorProtocol::SET_PROTOCOL_ASCII;
+
+        QMetaObject::invokeMethod(acquisition, "sendData", Qt::QueuedConnection,
+                                  Q_ARG(QString, QString::fromStdString(command) + "\n"));
+        QMetaObject::invokeMethod(acquisition, "setBinaryMode", Qt::QueuedConnection,
+                                  Q_ARG(bool, status));
     }
 
-    std::vector<double>& Controller::getRealPart()
+    void Controller::setEffectiveSize(int size)
     {
-        return fft->getRealPart();
+        withFFTSettings([size](FFT_settings & settings) {
+            settings.numberOfSamples = size;
+        });
     }
 
-    std::vector<double>& Controller::getImaginaryPart()
+    void Controller::setSlidingWindowSize(int size)
     {
-        return fft->getImaginaryPart();
+        withFFTSettings([size](FFT_settings & settings) {
+            settings.slidingWindow = size;
+        });
     }
 
-    fftw_complex *Controller::getIn()
+    void Controller::setZeroPadSize(int size)
     {
-        return fft->getIn();
+        withFFTSettings([size](FFT_settings & settings) {
+            settings.zeroPaddingSamples = size;
+        });
     }
 
-    double Controller::indexToFrequency(int i)
+    void Controller::setUseFilter(bool status)
     {
-        return fft->indexToFrequency(i);
+        withFFTSettings([status](FFT_settings & settings) {
+            settings.useIdealFilter = status;
+        });
     }
 
-    void Controller::setEffectiveSize(int size)
+    void Controller::setUseScaling(bool status)
     {
-        if (!fft)
-            return;
-
-        fft->setSampleSettings(size,
-                               fft->getProperties().zeroPaddingSamples,
-                               fft->getProperties().slidingWindow);
+        withFFTSettings([status](FFT_settings & settings) {
+            settings.useScaling = status;
+        });
     }
 
-    void Controller::setSlidingWindowSize(int size)
+    void Controller::setUseWindowFunction(bool status)
     {
-        if (!fft)
-            return;
-
-        fft->setSampleSettings(fft->getProperties().numberOfSamples,
-                               fft->getProperties().zeroPaddingSamples,
-                               size);
+        withFFTSettings([status](FFT_settings & settings) {
+            settings.useWindowFunction = status;
+        });
     }
 
-    void Controller::setZeroPadSize(int size)
+    void Controller::setUseComplexFFT(bool status)
     {
-        if (!fft)
-            return;
-
-        fft->setSampleSettings(fft->getProperties().numberOfSamples,
-                               size,
-                               fft->getProperties().slidingWindow);
+        withFFTSettings([status](FFT_settings & settings) {
+            settings.type = status ? C2C : R2C;
+        });
     }
 
-    void Controller::setUseFilter(bool status)
+    void Controller::setUseIRChannel(bool status)
     {
-        if (!fft)
-            return;
-
-        fft->setUseFilter(status);
+        withFFTSettings([status](FFT_settings & settings) {
+            settings.channels = status ? SENSOR_CHANNELS : 1;
+        });
     }
 
-    void Controller::setUseScaling(bool status)
+    void Controller::setWindowType(WINDOW_TYPE type)
     {
-        if (!fft)
-            return;
+        withFFTSettings([type](FFT_settings & settings) {
+            settings.windowType = type;
+        });
+    }
 
-        fft->setUseScaling(status);
+    void Controller::setUseAutocorrelation(bool status)
+    {
+        withFFTSettings([status](FFT_settings & settings) {
+            settings.useAutocorrelation = status;
+        });
     }
 
-    void Controller::setUseWindowFunction(bool status)
+    void Controller::setEngine(SPECTRUM_ENGINE engine)
     {
-        if (!fft)
-            return;
+        withFFTSettings([engine](FFT_settings & settings) {
+            settings.engine = engine;
+        });
+    }
 
-        fft->setUseWindowFunction(status);
+    void Controller::setPeakInterpolation(PEAK_INTERPOLATION interpolation)
+    {
+        withFFTSettings([interpolation](FFT_settings & settings) {
+            settings.peakInterpolation = interpolation;
+        });
     }
 
-    bool Controller::isRequiredFrequency(int index)
+    void Controller::setUseBeatDetector(bool status)
     {
-        return fft->isRequiredFrequency(index);
+        acquisition->setUseBeatDetector(status);
     }
 
 }
@@ -1,11 +1,13 @@
 /**
- * This class interfaces between Qt and the FFT classes.
+ * This class interfaces between Qt and the core pipeline.
  *
- * [Serial] <=> [Controller] <=> [FFT, FFTBuffer]
- * [Controller] <=> [GUI]
+ * [Serial, Pipeline: FFT, FFTBuffer] (Acquisition thread)
+ *     => SPSC queues => [Controller] <=> [GUI]
  *
- * Qts slot and signal mechanism is used for communication
- * between controller and GUI.
+ * Serial reading and signal processing run on the acquisition thread
+ * (see Acquisition), the Controller lives in the GUI thread. It drains
+ * the result queues when notified and emits the results with Qts
+ * slot and signal mechanism.
  *
  * @author Jens Gansloser
  */
@@ -13,12 +15,13 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
-#include <memory>
+#include <functional>
 
-#include "FFT.h"
-#include "Serial.h"
+#include "Acquisition.h"
 
 #include <QObject>
+#include <QThread>
+#include <QVector>
 
 namespace hrm
 {
@@ -28,50 +31,107 @@ namespace hrm
             Q_OBJECT
 
         private:
-            static const QString GET_SETTINGS_SERIAL;
-            static const QString SET_SAMPLE_INTERVAL_SERIAL;
-
-            Serial *serial;
-            std::unique_ptr<FFT> fft;
+            QThread thread;
+            Acquisition *acquisition;
 
             void initSignals();
 
+            /**
+             * Runs the function on the FFT of the acquisition thread
+             * (locked). Does nothing until the sensor settings are known.
+             */
+            void withFFT(std::function<void(FFT &fft)> function);
+
+            /**
+             * Changes the FFT settings of the acquisition. Unlike
+             * withFFT(), they are kept until the pipeline is created.
+             */
+            void withFFTSettings(std::function<void(FFT_settings &settings)> function);
+
         private slots:
-            void receiveSensorData(SensorData data);
-            void receiveSensorSettings(SensorSettings settings);
+            void dataAvailable();
 
         signals:
             void sensorSettings(
                 SensorSettings settings,
                 FFT_properties properties);
-            void sensorData(SensorData data);
-            void frequencySpectrum(
-                std::vector<double>& magnitude,
-                int peakIndex);
+            // All samples drained at one notification, in order
+            void sensorData(QVector<SensorData> data);
+            // The frame can be kept, it is not changed anymore.
+            void frequencySpectrum(SpectrumFramePtr frame);
+            // Every detected beat, in order
+            void beat(Beat beat);
+            void serialError(QString message);
+            void replayFinished();
 
         public:
             Controller();
             ~Controller();
 
-            FFT_properties getFFTProperties();
+            /**
+             * @retval false No pipeline yet (the sensor settings are not
+             * known), the properties are not changed.
+             */
+            bool getFFTProperties(FFT_properties &properties);
             bool start();
             void stop();
             void getSensorSettings();
             void setSampleInterval(QString sampleInterval);
 
+            /**
+             * Negotiates the binary framing with the sensor (or switches
+             * back to the text protocol).
+             */
+            void setBinaryProtocol(bool status);
+
+            /**
+             * Records the raw samples into the file (see Recording.h).
+             */
+            bool startRecording(QString fileName);
+
+            /**
+             * @retval false Writing the file failed (e.g. disk full).
+             */
+            bool stopRecording();
+
+            /**
+             * Replays a recorded session instead of the sensor data
+             * (see Replay.h). stop() ends it.
+             */
+            bool startReplay(QString fileName, bool realTime);
+
+            /**
+             * Latencies and counters of the acquisition (see
+             * Statistics.h).
+             */
+            Statistics &getStatistics();
+
+            /**
+             * Records the display and total latency of a frame (its
+             * peakTime and receiveTime). To be called after the GUI
+             * painted the frame.
+             */
+            void spectrumDisplayed(uint64_t peakTime, uint64_t receiveTime);
+
             // From FFT class
-            std::vector<double>& getMagnitude();
-            std::vector<double>& getRealPart();
-            std::vector<double>& getImaginaryPart();
-            fftw_complex *getIn();
-            double indexToFrequency(int i);
             void setEffectiveSize(int size);
             void setZeroPadSize(int size);
             void setSlidingWindowSize(int size);
             void setUseFilter(bool status);
             void setUseWindowFunction(bool status);
+            void setWindowType(WINDOW_TYPE type);
             void setUseScaling(bool status);
-            bool isRequiredFrequency(int index);
+            void setUseComplexFFT(bool status);
+            void setUseIRChannel(bool status);
+            void setUseAutocorrelation(bool status);
+            void setEngine(SPECTRUM_ENGINE engine);
+            void setPeakInterpolation(PEAK_INTERPOLATION interpolation);
+
+            /**
+             * Runs the beat detector next to the FFT (see
+             * BeatDetector.h), its beats are emitted with beat().
+             */
+            void setUseBeatDetector(bool status);
     };
 
 }
@@ -0,0 +1,70 @@
+#include "SensorManager.h"
+
+namespace hrm
+{
+
+    SensorManager::SensorManager(int threads) : pool(threads)
+    {
+        ports = new SensorPorts(pool);
+        ports->moveToThread(&thread);
+
+        connect(&thread, SIGNAL(started()),
+                ports, SLOT(threadStarted()));
+        connect(ports, SIGNAL(portError(int, QString)),
+                this, SIGNAL(portError(int, QString)));
+
+        thread.start();
+    }
+
+    SensorManager::~SensorManager()
+    {
+        closeAll();
+
+        thread.quit();
+        thread.wait();
+
+        delete ports;
+    }
+
+    int SensorManager::openPort(QString portName, int baudrate)
+    {
+        int id = -1;
+
+        QMetaObject::invokeMethod(ports, "openPort",
+                                  Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(int, id),
+                                  Q_ARG(QString, portName),
+                                  Q_ARG(int, baudrate));
+
+        return id;
+    }
+
+    void SensorManager::closePort(int id)
+    {
+        QMetaObject::invokeMethod(ports, "closePort",
+                                  Qt::BlockingQueuedConnection,
+                                  Q_ARG(int, id));
+    }
+
+    void SensorManager::closeAll()
+    {
+        QMetaObject::invokeMethod(ports, "closeAll",
+                                  Qt::BlockingQueuedConnection);
+    }
+
+    std::vector<SensorStatus> SensorManager::getStatus()
+    {
+        return pool.getStatus();
+    }
+
+    SensorSummary SensorManager::getSummary()
+    {
+        return pool.getSummary();
+    }
+
+    SensorPool &SensorManager::getPool()
+    {
+        return pool;
+    }
+
+}
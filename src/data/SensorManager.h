@@ -0,0 +1,73 @@
+/**
+ * Serves many sensors at once (e.g. a ward), next to the single sensor
+ * of the Controller.
+ *
+ * [SensorPorts] (one I/O thread for all ports)
+ *     => [SensorPool: Pipeline per sensor] (ThreadPool workers)
+ *     <= [SensorManager] <=> [GUI]
+ *
+ * The number of threads does not grow with the number of sensors:
+ * One thread reads all ports, the parsing and FFTs of all sensors are
+ * scheduled on a fixed size thread pool.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef SENSOR_MANAGER_H
+#define SENSOR_MANAGER_H
+
+#include <vector>
+
+#include "SensorPool.h"
+#include "SensorPorts.h"
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+namespace hrm
+{
+
+    class SensorManager : public QObject
+    {
+            Q_OBJECT
+
+        private:
+            SensorPool pool;
+
+            QThread thread;
+            SensorPorts *ports;
+
+        signals:
+            void portError(int id, QString message);
+
+        public:
+            /**
+             * @param threads Workers of the pool, 0 for one per core.
+             */
+            SensorManager(int threads = 0);
+            ~SensorManager();
+
+            /**
+             * Opens the port with the default settings of Serial.
+             *
+             * @return Id of the sensor, -1 if the port could not be
+             * opened.
+             */
+            int openPort(QString portName, int baudrate = 9600);
+            void closePort(int id);
+            void closeAll();
+
+            std::vector<SensorStatus> getStatus();
+
+            /**
+             * Aggregated BPM of the sensors.
+             */
+            SensorSummary getSummary();
+
+            SensorPool &getPool();
+    };
+
+}
+
+#endif // SENSOR_MANAGER_H
@@ -0,0 +1,126 @@
+#include "SensorPorts.h"
+
+namespace hrm
+{
+
+    SensorPorts::SensorPorts(SensorPool &pool, QObject *parent) :
+        QObject(parent),
+        pool(pool)
+    {
+        // Child, so it is moved to the I/O thread as well.
+        settingsTimer = new QTimer(this);
+        connect(settingsTimer, SIGNAL(timeout()), this, SLOT(settingsTimeout()));
+    }
+
+    SensorPorts::~SensorPorts()
+    {
+    }
+
+    void SensorPorts::threadStarted()
+    {
+        Trace::instance().setThreadName("Sensor I/O");
+    }
+
+    int SensorPorts::openPort(QString portName, int baudrate)
+    {
+        SerialPortSettings settings = SerialPortSettings::getDefaultSettings();
+        QSerialPort *port = new QSerialPort(this);
+
+        port->setPortName(portName);
+        port->setBaudRate(baudrate);
+        port->setDataBits(settings.dataBits);
+        port->setParity(settings.parity);
+        port->setStopBits(settings.stopBits);
+        port->setFlowControl(settings.flowControl);
+
+        if (!port->open(QIODevice::ReadWrite)) {
+            delete port;
+            return -1;
+        }
+
+        int id = pool.addSensor(portName.toStdString());
+        port->setProperty("sensorId", id);
+        ports[id] = port;
+
+        connect(port, SIGNAL(readyRead()), this, SLOT(receiveData()));
+        connect(port, SIGNAL(error(QSerialPort::SerialPortError)), this,
+                SLOT(handleError(QSerialPort::SerialPortError)));
+
+        requestSettings(port);
+
+        if (!settingsTimer->isActive())
+            settingsTimer->start(SENSOR_SETTINGS_INTERVAL);
+
+        return id;
+    }
+
+    void SensorPorts::closePort(int id)
+    {
+        auto it = ports.find(id);
+        if (it == ports.end())
+            return;
+
+        QSerialPort *port = it->second;
+        ports.erase(it);
+
+        port->close();
+        port->deleteLater();
+
+        pool.removeSensor(id);
+
+        if (ports.empty())
+            settingsTimer->stop();
+    }
+
+    void SensorPorts::closeAll()
+    {
+        while (!ports.empty())
+            closePort(ports.begin()->first);
+    }
+
+    void SensorPorts::receiveData()
+    {
+        TRACE_SCOPE("SensorPorts::receiveData");
+
+        QSerialPort *port = qobject_cast<QSerialPort *>(sender());
+        if (!port)
+            return;
+
+        qint64 available = port->bytesAvailable();
+        if (available <= 0)
+            return;
+
+        receiveBuffer.resize(available);
+        qint64 bytesRead = port->read(receiveBuffer.data(), available);
+
+        if (bytesRead > 0)
+            pool.feed(port->property("sensorId").toInt(), receiveBuffer.constData(), bytesRead);
+    }
+
+    void SensorPorts::requestSettings(QSerialPort *port)
+    {
+        port->write(QString::fromStdString(SensorProtocol::GET_SETTINGS + '\n').toLocal8Bit());
+    }
+
+    void SensorPorts::settingsTimeout()
+    {
+        for (auto &entry : ports) {
+            if (!pool.isConfigured(entry.first))
+                requestSettings(entry.second);
+        }
+    }
+
+    void SensorPorts::handleError(QSerialPort::SerialPortError error)
+    {
+        QSerialPort *port = qobject_cast<QSerialPort *>(sender());
+        if (!port || error != QSerialPort::ResourceError)
+            return;
+
+        int id = port->property("sensorId").toInt();
+        QString message = port->errorString();
+        closePort(id);
+
+        Q_EMIT portError(id, message);
+    }
+
+}
@@ -0,0 +1,78 @@
+/**
+ * Serial ports of the SensorManager.
+ *
+ * The object lives in the I/O thread of the SensorManager. All ports
+ * are read by this one thread (Qts event loop multiplexes them), the
+ * bytes are passed unparsed to the SensorPool, which parses and
+ * processes them on its workers.
+ *
+ * Ports without known settings are asked for them again every
+ * SENSOR_SETTINGS_INTERVAL.
+ *
+ * @author Jens Gansloser
+ */
+
+#ifndef SENSOR_PORTS_H
+#define SENSOR_PORTS_H
+
+#include <map>
+
+#include "SensorPool.h"
+#include "Serial.h"
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QtSerialPort/QSerialPort>
+
+#define SENSOR_SETTINGS_INTERVAL 1000 // ms
+
+namespace hrm
+{
+
+    class SensorPorts : public QObject
+    {
+            Q_OBJECT
+
+        private:
+            SensorPool &pool;
+
+            // Sensor id => port
+            std::map<int, QSerialPort *> ports;
+            QTimer *settingsTimer;
+
+            // Reused for every read
+            QByteArray receiveBuffer;
+
+            void requestSettings(QSerialPort *port);
+
+        private slots:
+            void receiveData();
+            void handleError(QSerialPort::SerialPortError error);
+            void settingsTimeout();
+            void threadStarted();
+
+        public slots:
+            // Called via blocking queued connections.
+
+            /**
+             * @return Id of the sensor, -1 if the port could not be
+             * opened.
+             */
+            int openPort(QString portName, int baudrate);
+            void closePort(int id);
+            void closeAll();
+
+        signals:
+            // The port was closed.
+            void portError(int id, QString message);
+
+        public:
+            SensorPorts(SensorPool &pool, QObject *parent = 0);
+            ~SensorPorts();
+    };
+
+}
+
+#endif // SENSOR_PORTS_H
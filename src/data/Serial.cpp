@@ -1,7 +1,5 @@
 #include "Serial.h"
 
-#include <QMessageBox>
-
 namespace hrm
 {
 
@@ -9,6 +7,28 @@ namespace hrm
         QSerialPort(parent),
         settings(SerialPortSettings::getDefaultSettings())
     {
+        lineParser.setDataCallback([this](const SensorData & data) {
+            block[blockSize++] = data;
+            if (blockSize == SERIAL_BLOCK_SIZE)
+                flushBlock();
+        });
+        lineParser.setSettingsCallback([this](const SensorSettings & sensorSettings) {
+            // Keep the order of data and settings.
+            flushBlock();
+            Q_EMIT receiveSensorSettings(sensorSettings);
+        });
+        lineParser.setLineCallback([this](const char *line, size_t length) {
+            Q_EMIT receiveLine(QString::fromLatin1(line, length).trimmed());
+        });
+
+        frameParser.setSamplesCallback([this](const SensorData * data, int count, uint16_t) {
+            Q_EMIT receiveSensorDataBlock(data, count);
+        });
+        frameParser.setLineCallback([this](const char *line, size_t length) {
+            lineParser.parseLine(line, length);
+            flushBlock();
+        });
+
         connect(this, SIGNAL(readyRead()), this, SLOT(receiveData()));
         connect(this, SIGNAL(error(QSerialPort::SerialPortError)), this,
                 SLOT(handleError(QSerialPort::SerialPortError)));
@@ -20,48 +40,69 @@ namespace hrm
 
     void Serial::receiveData()
     {
-        if (canReadLine()) {
-            QByteArray line = readLine();
-            line.trimmed();
+        TRACE_SCOPE("Serial::receiveData");
 
-            parseData(line);
+        // Read everything into the (reused) receive buffer.
+        qint64 available = bytesAvailable();
+        if (available <= 0)
+            return;
 
-            Q_EMIT receiveLine(line);
-        }
+        receiveTime = Statistics::now();
+
+        int oldSize = receiveBuffer.size();
+        receiveBuffer.resize(oldSize + available);
+
+        qint64 bytesRead = read(receiveBuffer.data() + oldSize, available);
+        receiveBuffer.resize(oldSize + qMax<qint64>(bytesRead, 0));
+
+        // Parse all complete lines/frames in place.
+        size_t consumed;
+        if (binaryMode)
+            consumed = frameParser.parse(receiveBuffer.constData(), receiveBuffer.size());
+        else
+            consumed = lineParser.parse(receiveBuffer.constData(), receiveBuffer.size());
+
+        flushBlock();
+        receiveBuffer.remove(0, consumed);
     }
 
-    void Serial::parseData(QString line)
+    void Serial::flushBlock()
     {
-        QList<QString> dataWords = line.split(' ');
-
-        if (dataWords.size() >= 1) {
-            if (dataWords[0] == "data:") {
-                if (dataWords.size() != 5)
-                    return;
-
-                if (dataWords[1] == "broadband" && dataWords[3] == "ir") {
-                    SensorData data;
-                    data.broadband = dataWords[2].trimmed().toUShort();
-                    data.ir = dataWords[4].trimmed().toUShort();
-
-                    Q_EMIT receiveSensorData(data);
-                }
-            } else if (dataWords[0] == "settings:") {
-                if (dataWords.size() != 14)
-                    return;
-
-                SensorSettings settings;
-
-                settings.sensor = dataWords[2];
-                settings.id = dataWords[4];
-                settings.max = dataWords[6];
-                settings.min = dataWords[8];
-                settings.resolution = dataWords[10];
-                settings.sampleInterval = dataWords[12];
-
-                Q_EMIT receiveSensorSettings(settings);
-            }
-        }
+        if (blockSize == 0)
+            return;
+
+        int count = blockSize;
+        blockSize = 0;
+
+        Q_EMIT receiveSensorDataBlock(block, count);
+    }
+
+    void Serial::setBinaryMode(bool status)
+    {
+        binaryMode = status;
+
+        receiveBuffer.clear();
+        frameParser.reset();
+    }
+
+    bool Serial::isBinaryMode()
+    {
+        return binaryMode;
+    }
+
+    const FrameStatistics &Serial::getFrameStatistics()
+    {
+        return frameParser.getStatistics();
+    }
+
+    const LineStatistics &Serial::getLineStatistics()
+    {
+        return lineParser.getStatistics();
+    }
+
+    uint64_t Serial::getReceiveTime()
+    {
+        return receiveTime;
     }
 
     bool Serial::openSerial()
@@ -73,6 +114,10 @@ namespace hrm
         setStopBits(settings.stopBits);
         setFlowControl(settings.flowControl);
 
+        // The sensor may have restarted its frame counter meanwhile.
+        receiveBuffer.clear();
+        frameParser.reset();
+
         if (open(QIODevice::ReadWrite))
             return true;
         return false;
@@ -81,6 +126,9 @@ namespace hrm
     void Serial::closeSerial()
     {
         close();
+
+        receiveBuffer.clear();
+        frameParser.reset();
     }
 
     void Serial::sendData(QString string)
@@ -91,8 +139,10 @@ namespace hrm
     void Serial::handleError(QSerialPort::SerialPortError error)
     {
         if (error == QSerialPort::ResourceError) {
-            QMessageBox::critical(0, tr("Critical Error"), errorString());
+            QString message = errorString();
             closeSerial();
+
+            Q_EMIT criticalError(message);
         }
     }
 
@@ -2,7 +2,9 @@
  * This class uses QtSerialPort to receive data from a light sensor.
  *
  * It parses the incoming data and emits corresponding signals for
- * sensor data and settings.
+ * sensor data and settings. Each readyRead() drains all complete
+ * lines (or frames) of the receive buffer, data lines are batched into
+ * one receiveSensorDataBlock() signal.
  *
  * @author Jens Gansloser
  */
@@ -10,12 +12,18 @@
 #ifndef SERIAL_H
 #define SERIAL_H
 
-#include <stdint.h>
+#include "SensorProtocol.h"
+#include "FrameParser.h"
+#include "LineParser.h"
+#include "Statistics.h"
+#include "Trace.h"
 
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 #include <QString>
 
+#define SERIAL_BLOCK_SIZE 256
+
 namespace hrm
 {
 
@@ -41,39 +49,48 @@ namespace hrm
         }
     };
 
-    /**
-     * The data that can be received over serial.
-     */
-    struct SensorSettings {
-        QString sensor;
-        QString id;
-        QString max;
-        QString min;
-        QString resolution;
-        QString sampleInterval;
-    };
-
-    struct SensorData {
-        uint16_t broadband;
-        uint16_t ir;
-    };
-
     class Serial : public QSerialPort
     {
             Q_OBJECT
 
         private:
             SerialPortSettings settings;
-            void parseData(QString line);
+
+            // Binary framing mode
+            bool binaryMode = false;
+            FrameParser frameParser;
+            LineParser lineParser;
+
+            // Unparsed bytes (incomplete line or frame), reused.
+            QByteArray receiveBuffer;
+
+            // Parsed data lines of the current notification
+            SensorData block[SERIAL_BLOCK_SIZE];
+            int blockSize = 0;
+
+            // Statistics::now() of the current read
+            uint64_t receiveTime = 0;
+
+            void flushBlock();
 
         private slots:
             void receiveData();
             void handleError(QSerialPort::SerialPortError error);
 
         signals:
+            // All lines except data lines
             void receiveLine(QString data);
-            void receiveSensorData(SensorData data);
+            /**
+             * Batch of samples (one frame or the data lines of a read).
+             *
+             * The data points into a buffer of Serial (or the frame
+             * parser) that is reused by the next read, it is only valid
+             * during the call. Connect with Qt::DirectConnection only.
+             */
+            void receiveSensorDataBlock(const SensorData *data, int count);
             void receiveSensorSettings(SensorSettings settings);
+            // The port was closed (may run on a non-GUI thread).
+            void criticalError(QString message);
 
         public:
             Serial(QObject *parent = 0);
@@ -83,6 +100,22 @@ namespace hrm
             void closeSerial();
 
             void sendData(QString string);
+
+            /**
+             * Switches the receive path. The sensor has to be switched
+             * with SensorProtocol::SET_PROTOCOL_BINARY before.
+             */
+            void setBinaryMode(bool status);
+            bool isBinaryMode();
+
+            const FrameStatistics &getFrameStatistics();
+            const LineStatistics &getLineStatistics();
+
+            /**
+             * @return Statistics::now() of the read the current
+             * receiveSensorDataBlock() was parsed from.
+             */
+            uint64_t getReceiveTime();
     };
 
 }
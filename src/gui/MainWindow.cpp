@@ -1,10 +1,13 @@
 #include "MainWindow.h"
 
 #include <QMessageBox>
+#include <QFileDialog>
 #include <QList>
 #include <QTabWidget>
+#include <QFile>
 #include <iostream>
 
+#include <algorithm>
 #include <cmath>
 
 namespace hrm
@@ -14,6 +17,8 @@ namespace hrm
     {
         setupUi(this);
 
+        Trace::instance().setThreadName("GUI");
+
         console = new Console();
         mainLayout->layout()->addWidget(console);
 
@@ -26,6 +31,10 @@ namespace hrm
 
         initPlots();
         initSignals();
+
+        statisticsSnapshot = controller.getStatistics().snapshot();
+        statisticsTimer.start(STATISTICS_REFRESH_INTERVAL);
+        sensorTimer.start(SENSOR_REFRESH_INTERVAL);
     }
 
     void MainWindow::initPlots()
@@ -76,6 +85,30 @@ namespace hrm
                 this, SLOT(openSettingsDialogClicked()));
         connect(actionSettings_2, SIGNAL(triggered()),
                 this, SLOT(openSettingsDialogClicked()));
+        connect(actionRecord, SIGNAL(triggered(bool)),
+                this, SLOT(recordTriggered(bool)));
+        connect(actionReplay, SIGNAL(triggered()),
+                this, SLOT(replayTriggered()));
+        connect(actionReplayFast, SIGNAL(triggered()),
+                this, SLOT(replayFastTriggered()));
+        connect(actionTrace, SIGNAL(triggered(bool)),
+                this, SLOT(traceTriggered(bool)));
+
+        connect(&statisticsTimer, SIGNAL(timeout()),
+                this, SLOT(statisticsTimeout()));
+        connect(statisticsResetButton, SIGNAL(clicked()),
+                this, SLOT(statisticsResetClicked()));
+        connect(statisticsDumpButton, SIGNAL(clicked()),
+                this, SLOT(statisticsDumpClicked()));
+
+        connect(&sensorTimer, SIGNAL(timeout()),
+                this, SLOT(sensorTimeout()));
+        connect(sensorOpenButton, SIGNAL(clicked()),
+                this, SLOT(sensorOpenClicked()));
+        connect(sensorCloseButton, SIGNAL(clicked()),
+                this, SLOT(sensorCloseClicked()));
+        connect(&sensorManager, SIGNAL(portError(int, QString)),
+                this, SLOT(sensorPortError(int, QString)));
 
         // From settings dialog
         connect(settingsDialog->getSettingsBtn, SIGNAL(clicked()),
@@ -100,17 +133,41 @@ namespace hrm
 
         connect(windowFunctionCheckBox, SIGNAL(stateChanged(int)),
                 this, SLOT(windowFunctionCheckBoxChanged(int)));
+        connect(windowTypeComboBox, SIGNAL(currentIndexChanged(int)),
+                this, SLOT(windowTypeComboBoxChanged(int)));
         connect(filterCheckBox, SIGNAL(stateChanged(int)),
                 this, SLOT(filterCheckBoxChanged(int)));
         connect(scalingCheckBox, SIGNAL(stateChanged(int)),
                 this, SLOT(scalingCheckBoxChanged(int)));
+        connect(complexFFTCheckBox, SIGNAL(stateChanged(int)),
+                this, SLOT(complexFFTCheckBoxChanged(int)));
+        connect(irChannelCheckBox, SIGNAL(stateChanged(int)),
+                this, SLOT(irChannelCheckBoxChanged(int)));
+        connect(beatDetectorCheckBox, SIGNAL(stateChanged(int)),
+                this, SLOT(beatDetectorCheckBoxChanged(int)));
+        connect(autocorrelationCheckBox, SIGNAL(stateChanged(int)),
+                this, SLOT(autocorrelationCheckBoxChanged(int)));
+        connect(engineComboBox, SIGNAL(currentIndexChanged(int)),
+                this, SLOT(engineComboBoxChanged(int)));
+        connect(peakInterpolationComboBox, SIGNAL(currentIndexChanged(int)),
+                this, SLOT(peakInterpolationComboBoxChanged(int)));
+        connect(binaryProtocolCheckBox, SIGNAL(stateChanged(int)),
+                this, SLOT(binaryProtocolCheckBoxChanged(int)));
 
         connect(&controller, SIGNAL(sensorSettings(SensorSettings, FFT_properties)),
                 this, SLOT(sensorSettings(SensorSettings, FFT_properties)));
-        connect(&controller, SIGNAL(sensorData(SensorData)),
-                this, SLOT(sensorData(SensorData)));
-        connect(&controller, SIGNAL(frequencySpectrum(std::vector<double>&, int)),
-                this, SLOT(frequencySpectrum(std::vector<double>&, int)));
+        connect(&controller, SIGNAL(sensorData(QVector<SensorData>)),
+                this, SLOT(sensorData(QVector<SensorData>)));
+        connect(&controller, SIGNAL(frequencySpectrum(SpectrumFramePtr)),
+                this, SLOT(frequencySpectrum(SpectrumFramePtr)));
+        connect(plotFrequencyOut, SIGNAL(replotted()),
+                this, SLOT(spectrumReplotted()));
+        connect(&controller, SIGNAL(beat(Beat)),
+                this, SLOT(beat(Beat)));
+        connect(&controller, SIGNAL(serialError(QString)),
+                this, SLOT(serialError(QString)));
+        connect(&controller, SIGNAL(replayFinished()),
+                this, SLOT(replayFinished()));
     }
 
     MainWindow::~MainWindow()
@@ -138,88 +195,125 @@ namespace hrm
         slidingWindowSlider->setValue(properties.slidingWindow);
     }
 
-    void MainWindow::sensorData(SensorData data)
+    void MainWindow::sensorData(QVector<SensorData> data)
     {
-        QString str;
+        TRACE_SCOPE("MainWindow::sensorData");
 
-        QVector<double> dataVector;
-        dataVector.append(data.broadband);
+        QVector<double> dataVector(1);
+        QVector<double> broadband;
+        broadband.reserve(data.size());
 
-        plotBroadband->updatePlot(dataVector);
-        plotFrequencyIn->updatePlot(dataVector);
+        // The plots only repaint at their refresh rate.
+        for (const SensorData &sample : data) {
+            dataVector[0] = sample.broadband;
+            plotBroadband->updatePlot(dataVector);
+            plotFrequencyIn->updatePlot(dataVector);
 
-        dataVector.clear();
-        dataVector.append(data.ir);
-        plotIr->updatePlot(dataVector);
+            dataVector[0] = sample.ir;
+            plotIr->updatePlot(dataVector);
 
-        settingsDialog->setTimeDataEdit(data.broadband);
+            broadband.append(sample.broadband);
+        }
 
-        str = "Sensor> ";
-        str += "Broadband: " + QString::number(data.broadband)
-               + " Ir: " + QString::number(data.ir);
+        // The text widgets are updated once per batch.
+        settingsDialog->setTimeDataEdit(broadband.constData(), broadband.size());
 
-        console->print(str);
+        const SensorData &last = data.last();
+        console->print("Sensor> " + QString::number(data.size()) + " samples, last"
+                       + " Broadband: " + QString::number(last.broadband)
+                       + " Ir: " + QString::number(last.ir));
     }
 
-    void MainWindow::frequencySpectrum(
-        std::vector<double>& magnitude,
-        int peakIndex)
+    void MainWindow::frequencySpectrum(SpectrumFramePtr frame)
     {
-        std::vector<double>& real = controller.getRealPart();
-        std::vector<double>& imaginary = controller.getImaginaryPart();
-        FFT_properties properties = controller.getFFTProperties();
+        TRACE_SCOPE("MainWindow::frequencySpectrum");
+
+        const FFT_properties &properties = frame->properties;
 
-        settingsDialog->clearFrequencyDataEdit();
         settingsDialog->clearTimeDataEdit();
-        plotFrequencyOut->clear();
-        plotFrequencyOutComplexData->clear();
 
         // Max peak
-        displayPeak(peakIndex, magnitude[peakIndex]);
-
-        QVector<double> dataVector;
-        QString str;
+        if (frame->peak.index >= 0)
+            displayPeak(*frame);
+        else
+            plotFrequencyOut->clearMarker();
+
+        // Bins between min and max frequency (vector index i-1 is bin i)
+        int first = properties.firstBin;
+        int size = std::max(0, properties.lastBin - first + 1);
+        double x0 = frame->indexToFrequency(first);
+        double dx = frame->indexToFrequency(1);
+
+        const double *magnitude = frame->magnitude.data() + first - 1;
+        const double *real = frame->real.data() + first - 1;
+        const double *imaginary = frame->imaginary.data() + first - 1;
+
+        plotFrequencyOut->setSeries(x0, dx, {magnitude}, size);
+        plotFrequencyOutComplexData->setSeries(x0, dx, {real, imaginary}, size);
+        settingsDialog->setFrequencyDataEdit(magnitude, size);
+
+        plotFrequencyInPaddedData->setSeries(0.0, 1.0, {frame->input.data()},
+                                             properties.numberOfSamples);
+
+        // Recorded when the plot is painted (replots are coalesced).
+        spectrumPeakTime = frame->peakTime;
+        spectrumReceiveTime = frame->receiveTime;
+    }
 
-        // Plot
-        for (int i = 1; i <= properties.totalSamples / 2; ++i) {
-            if (!controller.isRequiredFrequency(i))
-                continue;
+    void MainWindow::spectrumReplotted()
+    {
+        if (spectrumPeakTime == 0)
+            return;
 
-            dataVector.clear();
+        controller.spectrumDisplayed(spectrumPeakTime, spectrumReceiveTime);
+        spectrumPeakTime = 0;
+    }
 
-            dataVector.append(magnitude[i-1]);
-            plotFrequencyOut->updatePlot(controller.indexToFrequency(i), dataVector);
+    void MainWindow::displayPeak(const SpectrumFrame &frame)
+    {
+        const Peak &peak = frame.peak;
 
-            dataVector.clear();
-            dataVector.append(real[i-1]);
-            dataVector.append(imaginary[i-1]);
-            plotFrequencyOutComplexData->updatePlot(controller.indexToFrequency(i), dataVector);
+        double fraction = peak.frequency / frame.properties.sampleRate;
+        double bpm = peak.frequency * 60;
 
-            settingsDialog->setFrequencyDataEdit(magnitude[i-1]);
-        }
+        settingsDialog->setPeakInfo(peak.index + peak.offset, fraction,
+                                    peak.frequency, peak.magnitude, bpm,
+                                    peak.confidence);
 
-        fftw_complex *inPadded = controller.getIn();
-        plotFrequencyInPaddedData->clear();
-        for (int i = 0; i < controller.getFFTProperties().numberOfSamples; ++i) {
-            dataVector.clear();
-            dataVector.append(inPadded[i][0]);
-            plotFrequencyInPaddedData->updatePlot(dataVector);
-        }
-    }
+        lcdNumber->display(bpm);
+        fftBpm = bpm;
 
-    void MainWindow::displayPeak(int indexMax, double max)
-    {
-        FFT_properties properties = controller.getFFTProperties();
+        if (frame.channelPeaks.size() > CHANNEL_IR) {
+            channelLabel->setText(QString("IR: %1 bpm, combined: %2 bpm, ratio: %3")
+                                  .arg(frame.channelPeaks[CHANNEL_IR].frequency * 60, 0, 'f', 1)
+                                  .arg(frame.combinedPeak.frequency * 60, 0, 'f', 1)
+                                  .arg(frame.ratio, 0, 'f', 3));
+        } else
+            channelLabel->clear();
 
-        double fraction = indexMax / (double) properties.totalSamples;
-        double frequency = properties.sampleRate * fraction;
-        double bpm = frequency * 60;
+        const AutocorrelationPeak &autocorrelation = frame.autocorrelationPeak;
 
-        settingsDialog->setPeakInfo(indexMax, fraction, frequency, max, bpm);
+        if (autocorrelation.lag >= 0) {
+            autocorrelationLabel->setText(QString("Autocorrelation: %1 bpm, lag: %2, r: %3")
+                                          .arg(autocorrelation.frequency * 60, 0, 'f', 1)
+                                          .arg(autocorrelation.lag + autocorrelation.offset, 0, 'f', 2)
+                                          .arg(autocorrelation.correlation, 0, 'f', 2));
+        } else
+            autocorrelationLabel->clear();
 
-        lcdNumber->display(bpm);
+        plotFrequencyOut->setMarker(peak.frequency, peak.magnitude);
+    }
 
-        plotFrequencyOut->addMarker(frequency, max);
+    void MainWindow::beat(Beat beat)
+    {
+        if (beat.averageBpm <= 0.0)
+            return;
+
+        beatLabel->setText(QString("Beats: %1 bpm (instant %2), latency: %3 ms, to FFT: %4 bpm")
+                           .arg(beat.averageBpm, 0, 'f', 1)
+                           .arg(beat.bpm, 0, 'f', 1)
+                           .arg(beat.latency * 1000, 0, 'f', 0)
+                           .arg(beat.averageBpm - fftBpm, 0, 'f', 1));
     }
 
     void MainWindow::openSerialPortClicked()
@@ -243,6 +337,12 @@ namespace hrm
         statusbar->showMessage(tr("Disconnected"));
     }
 
+    void MainWindow::serialError(QString message)
+    {
+        closeSerialPortClicked();
+        QMessageBox::critical(this, tr("Critical Error"), message);
+    }
+
     void MainWindow::getSettingsClicked()
     {
         controller.getSensorSettings();
@@ -254,6 +354,222 @@ namespace hrm
         settingsDialog->setVisible(true);
     }
 
+    void MainWindow::recordTriggered(bool checked)
+    {
+        if (!checked) {
+            if (controller.stopRecording())
+                console->printInfo("> Recording stopped");
+            else
+                QMessageBox::critical(this, tr("Error"),
+                                      "Writing the recording failed, the file is incomplete.");
+            return;
+        }
+
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Record session"),
+                           QString(), tr("HRM recordings (*.hrmr)"));
+
+        if (fileName.isEmpty() || !controller.startRecording(fileName)) {
+            actionRecord->setChecked(false);
+
+            if (!fileName.isEmpty())
+                QMessageBox::critical(this, tr("Error"),
+                                      "Could not start recording (connect the sensor first).");
+            return;
+        }
+
+        console->printInfo("> Recording to " + fileName);
+    }
+
+    void MainWindow::replayTriggered()
+    {
+        startReplay(true);
+    }
+
+    void MainWindow::replayFastTriggered()
+    {
+        startReplay(false);
+    }
+
+    /**
+     * The recorded session replaces the sensor until it is finished or
+     * Disconnect is clicked.
+     */
+    void MainWindow::startReplay(bool realTime)
+    {
+        QString fileName = QFileDialog::getOpenFileName(this, tr("Replay session"),
+                           QString(), tr("Sessions (*.hrmr *.log *.txt);;All files (*)"));
+        if (fileName.isEmpty())
+            return;
+
+        if (!controller.startReplay(fileName, realTime)) {
+            QMessageBox::critical(this, tr("Error"), "Could not open " + fileName);
+            return;
+        }
+
+        statusbar->showMessage(tr("Replaying"));
+        console->printInfo("> Replaying " + fileName);
+
+        actionConnect->setEnabled(false);
+        actionDisconnect->setEnabled(true);
+    }
+
+    void MainWindow::replayFinished()
+    {
+        closeSerialPortClicked();
+        console->printInfo("> Replay finished");
+    }
+
+    /**
+     * Checking starts tracing, unchecking stops it and writes the
+     * spans as Chrome trace-event JSON (open in Perfetto).
+     */
+    void MainWindow::traceTriggered(bool checked)
+    {
+        Trace &trace = Trace::instance();
+
+        if (checked) {
+            trace.start();
+            console->printInfo("> Tracing started");
+            return;
+        }
+
+        trace.stop();
+
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Save trace"),
+                           QString(), tr("Trace events (*.json)"));
+        if (fileName.isEmpty())
+            return;
+
+        if (!trace.writeJSON(fileName.toLocal8Bit().constData())) {
+            QMessageBox::critical(this, tr("Error"), "Could not write " + fileName);
+            return;
+        }
+
+        console->printInfo("> Trace written to " + fileName);
+    }
+
+    /**
+     * The rates are calculated over one refresh interval. The text is
+     * only built while the statistics tab is shown.
+     */
+    void MainWindow::statisticsTimeout()
+    {
+        Statistics &statistics = controller.getStatistics();
+
+        if (tabWidget->currentWidget() == tabStatistics) {
+            std::string report = statistics.report(statisticsSnapshot);
+            statisticsEdit->setPlainText(QString::fromStdString(report));
+        }
+
+        statisticsSnapshot = statistics.snapshot();
+    }
+
+    void MainWindow::statisticsResetClicked()
+    {
+        controller.getStatistics().reset();
+        statisticsSnapshot = controller.getStatistics().snapshot();
+    }
+
+    void MainWindow::statisticsDumpClicked()
+    {
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Dump statistics"),
+                           QString(), tr("Text files (*.txt)"));
+        if (fileName.isEmpty())
+            return;
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QMessageBox::critical(this, tr("Error"), "Could not create " + fileName);
+            return;
+        }
+
+        // Rates since the last refresh
+        std::string report = controller.getStatistics().report(statisticsSnapshot);
+        file.write(report.c_str(), report.size());
+
+        console->printInfo("> Statistics written to " + fileName);
+    }
+
+    void MainWindow::sensorOpenClicked()
+    {
+        QString portName = sensorPortEdit->text().trimmed();
+        if (portName.isEmpty())
+            return;
+
+        int id = sensorManager.openPort(portName);
+        if (id < 0) {
+            QMessageBox::critical(this, tr("Error"), "Could not open " + portName + ".");
+            return;
+        }
+
+        console->printInfo(QString("> Sensor %1 opened on %2").arg(id).arg(portName));
+        sensorPortEdit->clear();
+        sensorTimeout();
+    }
+
+    void MainWindow::sensorCloseClicked()
+    {
+        QList<QTableWidgetItem *> items = sensorTable->selectedItems();
+
+        for (QTableWidgetItem *item : items) {
+            if (item->column() == 0)
+                sensorManager.closePort(item->data(Qt::UserRole).toInt());
+        }
+
+        sensorTimeout();
+    }
+
+    void MainWindow::sensorPortError(int id, QString message)
+    {
+        console->printInfo(QString("> Sensor %1 closed: %2").arg(id).arg(message));
+    }
+
+    /**
+     * The table is only updated while the sensors tab is shown.
+     */
+    void MainWindow::sensorTimeout()
+    {
+        if (tabWidget->currentWidget() != tabSensors)
+            return;
+
+        std::vector<SensorStatus> sensors = sensorManager.getStatus();
+        sensorTable->setRowCount(sensors.size());
+
+        for (size_t i = 0; i < sensors.size(); ++i) {
+            const SensorStatus &sensor = sensors[i];
+            QString status;
+
+            if (!sensor.configured)
+                status = tr("Waiting for settings");
+            else if (sensor.bpmAge < 0.0)
+                status = tr("Buffering");
+            else if (sensor.bpmAge > SENSOR_ACTIVE_TIMEOUT)
+                status = tr("No data");
+            else
+                status = tr("Active");
+
+            QTableWidgetItem *port = new QTableWidgetItem(QString::fromStdString(sensor.name));
+            port->setData(Qt::UserRole, sensor.id);
+
+            sensorTable->setItem(i, 0, port);
+            sensorTable->setItem(i, 1, new QTableWidgetItem(QString::number(sensor.bpm, 'f', 1)));
+            sensorTable->setItem(i, 2, new QTableWidgetItem(QString::number(sensor.samples)));
+            sensorTable->setItem(i, 3, new QTableWidgetItem(QString::number(sensor.spectra)));
+            sensorTable->setItem(i, 4, new QTableWidgetItem(status));
+        }
+
+        SensorSummary summary = sensorManager.getSummary();
+
+        if (summary.active > 0)
+            sensorSummaryLabel->setText(QString("%1 of %2 sensors active, BPM mean %3, min %4, max %5")
+                                        .arg(summary.active).arg(summary.sensors)
+                                        .arg(summary.meanBpm, 0, 'f', 1)
+                                        .arg(summary.minBpm, 0, 'f', 1)
+                                        .arg(summary.maxBpm, 0, 'f', 1));
+        else
+            sensorSummaryLabel->setText(QString("%1 sensors, none active").arg(summary.sensors));
+    }
+
     /**
      * Sets sample interval on light sensor.
      *
@@ -274,20 +590,41 @@ namespace hrm
         console->printInfo("> Setting effective sample size to " +
                            QString::number(effectiveSamplesSlider->value()));
 
-        settingsDialog->setFFTInfo(controller.getFFTProperties());
-        plotFrequencyIn->setLimit(controller.getFFTProperties().numberOfSamples);
+        updateFFTInfo();
+    }
+
+    void MainWindow::irChannelCheckBoxChanged(int state)
+    {
+        controller.setUseIRChannel(state);
+        console->printInfo(state ? "> Processing broadband and IR channel"
+                                 : "> Processing broadband channel");
+
         plotFrequencyIn->clear();
     }
 
+    void MainWindow::beatDetectorCheckBoxChanged(int state)
+    {
+        controller.setUseBeatDetector(state);
+        console->printInfo(state ? "> Beat detector on" : "> Beat detector off");
+
+        beatLabel->clear();
+    }
+
+    void MainWindow::autocorrelationCheckBoxChanged(int state)
+    {
+        controller.setUseAutocorrelation(state);
+        console->printInfo(state ? "> Autocorrelation on" : "> Autocorrelation off");
+
+        autocorrelationLabel->clear();
+    }
+
     void MainWindow::zeroPaddingSamplesSliderReleased()
     {
         controller.setZeroPadSize(zeroPaddingSamplesSlider->value());
         console->printInfo("> Setting zero padding sample size to " +
                            QString::number(zeroPaddingSamplesSlider->value()));
 
-        settingsDialog->setFFTInfo(controller.getFFTProperties());
-        plotFrequencyIn->setLimit(controller.getFFTProperties().numberOfSamples);
-        plotFrequencyIn->clear();
+        updateFFTInfo();
     }
 
     void MainWindow::slidingWindowSliderReleased()
@@ -296,8 +633,20 @@ namespace hrm
         console->printInfo("> Setting sliding window size to " +
                            QString::number(slidingWindowSlider->value()));
 
-        settingsDialog->setFFTInfo(controller.getFFTProperties());
-        plotFrequencyIn->setLimit(controller.getFFTProperties().numberOfSamples);
+        updateFFTInfo();
+    }
+
+    void MainWindow::updateFFTInfo()
+    {
+        FFT_properties properties;
+
+        // Before the sensor settings are known, the settings are only
+        // stored, sensorSettings() shows them.
+        if (controller.getFFTProperties(properties)) {
+            settingsDialog->setFFTInfo(properties);
+            plotFrequencyIn->setLimit(properties.numberOfSamples);
+        }
+
         plotFrequencyIn->clear();
     }
 
@@ -326,6 +675,16 @@ namespace hrm
         controller.setUseWindowFunction(state);
     }
 
+    /**
+     * The combo box items have the same order as WINDOW_TYPE.
+     */
+    void MainWindow::windowTypeComboBoxChanged(int index)
+    {
+        controller.setWindowType((WINDOW_TYPE) index);
+        console->printInfo("> Setting window function to " +
+                           windowTypeComboBox->itemText(index));
+    }
+
     void MainWindow::filterCheckBoxChanged(int state)
     {
         controller.setUseFilter(state);
@@ -336,6 +695,44 @@ namespace hrm
         controller.setUseScaling(state);
     }
 
+    void MainWindow::complexFFTCheckBoxChanged(int state)
+    {
+        controller.setUseComplexFFT(state);
+        console->printInfo(state ? "> Using complex FFT (c2c)"
+                                 : "> Using real FFT (r2c)");
+
+        updateFFTInfo();
+    }
+
+    /**
+     * The combo box items have the same order as SPECTRUM_ENGINE.
+     */
+    void MainWindow::engineComboBoxChanged(int index)
+    {
+        controller.setEngine((SPECTRUM_ENGINE) index);
+        console->printInfo("> Using spectral engine " +
+                           engineComboBox->itemText(index));
+
+        plotFrequencyIn->clear();
+    }
+
+    /**
+     * The combo box items have the same order as PEAK_INTERPOLATION.
+     */
+    void MainWindow::peakInterpolationComboBoxChanged(int index)
+    {
+        controller.setPeakInterpolation((PEAK_INTERPOLATION) index);
+        console->printInfo("> Using peak interpolation " +
+                           peakInterpolationComboBox->itemText(index));
+    }
+
+    void MainWindow::binaryProtocolCheckBoxChanged(int state)
+    {
+        controller.setBinaryProtocol(state);
+        console->printInfo(state ? "> Switching to binary protocol"
+                                 : "> Switching to text protocol");
+    }
+
     void MainWindow::about()
     {
         QMessageBox::about(this, tr("About HRM"),
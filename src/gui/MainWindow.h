@@ -9,6 +9,7 @@
 
 #include <QWidget>
 #include <QString>
+#include <QTimer>
 
 #include "ui_MainWindow.h"
 
@@ -16,7 +17,13 @@
 #include "Console.h"
 #include "FFT.h"
 #include "Controller.h"
+#include "SensorManager.h"
 #include "SettingsDialog.h"
+#include "Statistics.h"
+#include "Trace.h"
+
+#define STATISTICS_REFRESH_INTERVAL 1000 // ms
+#define SENSOR_REFRESH_INTERVAL 1000 // ms
 
 namespace hrm
 {
@@ -27,6 +34,8 @@ namespace hrm
 
         private:
             Controller controller;
+            // Additional sensors (Sensors tab)
+            SensorManager sensorManager;
 
             minotaur::MouseMonitorPlot *plotBroadband;
             minotaur::MouseMonitorPlot *plotIr;
@@ -39,10 +48,27 @@ namespace hrm
             Console *console;
             SettingsDialog *settingsDialog;
 
+            QTimer statisticsTimer;
+            // For the rates of the statistics tab
+            StatisticsSnapshot statisticsSnapshot;
+
+            QTimer sensorTimer;
+
+            // Last BPM of the FFT, compared to the beat detector
+            double fftBpm = 0.0;
+
+            // Times of the newest spectrum that is not painted yet
+            // (see Controller::spectrumDisplayed()), 0: none.
+            uint64_t spectrumPeakTime = 0;
+            uint64_t spectrumReceiveTime = 0;
+
             void initPlots();
             void initSignals();
 
-            void displayPeak(int indexMax, double max);
+            void displayPeak(const SpectrumFrame &frame);
+            // After a FFT setting changed
+            void updateFFTInfo();
+            void startReplay(bool realTime);
 
         private slots:
             void about();
@@ -51,6 +77,18 @@ namespace hrm
             void closeSerialPortClicked();
             void getSettingsClicked();
             void openSettingsDialogClicked();
+            void recordTriggered(bool checked);
+            void replayTriggered();
+            void replayFastTriggered();
+            void replayFinished();
+            void traceTriggered(bool checked);
+            void statisticsTimeout();
+            void statisticsResetClicked();
+            void statisticsDumpClicked();
+            void sensorOpenClicked();
+            void sensorCloseClicked();
+            void sensorTimeout();
+            void sensorPortError(int id, QString message);
 
             void sampleIntervalSliderReleased();
             void effectiveSamplesSliderReleased();
@@ -62,16 +100,25 @@ namespace hrm
             void slidingWindowSliderChanged(int value);
 
             void windowFunctionCheckBoxChanged(int state);
+            void windowTypeComboBoxChanged(int index);
             void filterCheckBoxChanged(int state);
             void scalingCheckBoxChanged(int state);
+            void complexFFTCheckBoxChanged(int state);
+            void irChannelCheckBoxChanged(int state);
+            void beatDetectorCheckBoxChanged(int state);
+            void autocorrelationCheckBoxChanged(int state);
+            void engineComboBoxChanged(int index);
+            void peakInterpolationComboBoxChanged(int index);
+            void binaryProtocolCheckBoxChanged(int state);
 
             void sensorSettings(
                 SensorSettings settings,
                 FFT_properties properties);
-            void sensorData(SensorData data);
-            void frequencySpectrum(
-                std::vector<double>& magnitude,
-                int peakIndex);
+            void sensorData(QVector<SensorData> data);
+            void frequencySpectrum(SpectrumFramePtr frame);
+            void spectrumReplotted();
+            void beat(Beat beat);
+            void serialError(QString message);
 
         public:
             MainWindow(QWidget *parent = 0);
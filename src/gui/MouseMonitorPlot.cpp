@@ -1,4 +1,5 @@
 #include "MouseMonitorPlot.h"
+#include "Trace.h"
 
 #include <qwt_symbol.h>
 
@@ -7,6 +8,65 @@
 namespace minotaur
 {
 
+    void RingSeriesData::setCapacity(int capacity)
+    {
+        this->capacity = capacity;
+
+        clear();
+        points.reserve(capacity);
+    }
+
+    void RingSeriesData::append(const QPointF &point)
+    {
+        if (capacity == 0 || points.size() < capacity) {
+            points.append(point);
+            return;
+        }
+
+        points[start] = point;
+        start = (start + 1) % capacity;
+    }
+
+    void RingSeriesData::clear()
+    {
+        // Keeps the allocated memory.
+        points.resize(0);
+        start = 0;
+    }
+
+    void RingSeriesData::assign(const double *x, const double *y, int size)
+    {
+        points.resize(size);
+        start = 0;
+
+        for (int i = 0; i < size; ++i)
+            points[i] = QPointF(x[i], y[i]);
+    }
+
+    void RingSeriesData::assign(double x0, double dx, const double *y, int size)
+    {
+        points.resize(size);
+        start = 0;
+
+        for (int i = 0; i < size; ++i)
+            points[i] = QPointF(x0 + i * dx, y[i]);
+    }
+
+    size_t RingSeriesData::size() const
+    {
+        return points.size();
+    }
+
+    QPointF RingSeriesData::sample(size_t i) const
+    {
+        return points[(start + i) % points.size()];
+    }
+
+    QRectF RingSeriesData::boundingRect() const
+    {
+        return qwtBoundingRect(*this);
+    }
+
     void MouseMonitorPlot::init(QColor color,
                                 std::string title,
                                 std::string xAxisTitle,
@@ -18,14 +78,14 @@ namespace minotaur
         xStep = maxSize * 0.10;
         this->type = type;
 
+        replotTimer.setSingleShot(true);
+        setRefreshRate(DEFAULT_REFRESH_RATE);
+        connect(&replotTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+
         legend = new QwtLegend(this);
         this->insertLegend(legend);
 
-        auto cContainer = std::make_shared<CurveContainer>(curveTitle.c_str(), color);
-        cContainer->curve.setSamples(xData, cContainer->yData);
-        cContainer->curve.attach(this);
-
-        curves.append(cContainer);
+        addCurve(curveTitle.c_str(), color);
 
         setTitle(QString(title.c_str()));
         setAxisTitle(QwtPlot::xBottom, QString(xAxisTitle.c_str()));
@@ -38,50 +98,113 @@ namespace minotaur
             setAxisScale(QwtPlot::xBottom, 0, maxSize, xStep);
     }
 
-    void MouseMonitorPlot::updatePlot(QVector<double> data)
+    void MouseMonitorPlot::updatePlot(const QVector<double> &data)
     {
-        updatePlot(xData.size(), data);
+        updatePlot(nextIndex, data);
     }
 
-    void MouseMonitorPlot::updatePlot(double xIndex, QVector<double> data)
+    void MouseMonitorPlot::updatePlot(double xIndex, const QVector<double> &data)
     {
         if (data.size() != curves.size())
             return;
 
-        xData.append(xIndex);
+        nextIndex = xIndex + 1;
 
-        for (int i = 0; i < data.size(); ++i) {
-            curves[i]->update(data.at(i));
-            curves[i]->curve.setSamples(xData, curves[i]->yData);
-        }
+        for (int i = 0; i < data.size(); ++i)
+            curves[i]->update(xIndex, data.at(i));
 
-        if (type == LIMITED && xData.size() == maxSize) {
-            clear();
-        }
+        scheduleReplot();
+    }
+
+    void MouseMonitorPlot::setSeries(const double *x,
+                                     std::initializer_list<const double *> ys, int size)
+    {
+        if ((int) ys.size() != curves.size())
+            return;
+
+        int i = 0;
+        for (const double *y : ys)
+            curves[i++]->data->assign(x, y, size);
+        nextIndex = size;
+
+        scheduleReplot();
+    }
+
+    void MouseMonitorPlot::setSeries(double x0, double dx,
+                                     std::initializer_list<const double *> ys, int size)
+    {
+        if ((int) ys.size() != curves.size())
+            return;
+
+        int i = 0;
+        for (const double *y : ys)
+            curves[i++]->data->assign(x0, dx, y, size);
+        nextIndex = size;
+
+        scheduleReplot();
+    }
+
+    void MouseMonitorPlot::scheduleReplot()
+    {
+        // Points added until the timeout are drawn together.
+        if (!replotTimer.isActive())
+            replotTimer.start();
+    }
+
+    void MouseMonitorPlot::refresh()
+    {
+        TRACE_SCOPE("MouseMonitorPlot::refresh");
+
+        // Scroll to the newest maxSize points.
+        if (type == LIMITED && nextIndex > maxSize)
+            setAxisScale(QwtPlot::xBottom, nextIndex - maxSize, nextIndex, xStep);
 
         replot();
+
+        Q_EMIT replotted();
+    }
+
+    void MouseMonitorPlot::setRefreshRate(int refreshRate)
+    {
+        replotTimer.setInterval(1000 / qMax(refreshRate, 1));
     }
 
     void MouseMonitorPlot::addCurve(QString curveTitle, QColor color)
     {
         auto cContainer = std::make_shared<CurveContainer>(curveTitle, color);
-        cContainer->curve.setSamples(xData, cContainer->yData);
+        if (type == LIMITED)
+            cContainer->data->setCapacity(maxSize);
         cContainer->curve.attach(this);
 
         curves.append(cContainer);
     }
 
-    void MouseMonitorPlot::addMarker(double xPos, double yPos)
+    void MouseMonitorPlot::setMarker(double xPos, double yPos)
     {
-        QwtSymbol *s = new QwtSymbol(QwtSymbol::RTriangle, Qt::blue, Qt::NoPen, QSize(10, 10));
-        marker = new QwtPlotMarker();
+        // Created once, owned by the plot after attach().
+        if (marker == nullptr) {
+            QwtSymbol *s = new QwtSymbol(QwtSymbol::RTriangle, Qt::blue, Qt::NoPen, QSize(10, 10));
+            marker = new QwtPlotMarker();
+
+            //s->setPinPoint( QPointF( 0.0, 0.0 ) );
+            marker->setLabel(QwtText("Peak"));
+            marker->setSymbol(s);
+            marker->setLabelAlignment(Qt::AlignRight);
+        }
 
-        //s->setPinPoint( QPointF( 0.0, 0.0 ) );
-        marker->setLabel(QwtText("Peak"));
-        marker->setSymbol(s);
         marker->setValue(QPointF(xPos, yPos));
-        marker->setLabelAlignment(Qt::AlignRight);
-        marker->attach(this);
+        if (marker->plot() != this)
+            marker->attach(this);
+
+        scheduleReplot();
+    }
+
+    void MouseMonitorPlot::clearMarker()
+    {
+        if (marker != nullptr)
+            marker->detach();
+
+        scheduleReplot();
     }
 
     void MouseMonitorPlot::setLimit(int limit)
@@ -89,7 +212,14 @@ namespace minotaur
         maxSize = limit;
         xStep = maxSize * 0.15;
 
+        if (type == LIMITED) {
+            for (auto i : curves)
+                i->data->setCapacity(maxSize);
+            nextIndex = 0;
+        }
+
         setAxisScale(QwtPlot::xBottom, 0, maxSize, xStep);
+        scheduleReplot();
     }
 
     void MouseMonitorPlot::setSticksStyle()
@@ -111,21 +241,24 @@ namespace minotaur
     void MouseMonitorPlot::clear()
     {
         for (auto i : curves)
-            i->yData.clear();
-        xData.clear();
+            i->data->clear();
+        nextIndex = 0;
+
+        if (type == LIMITED)
+            setAxisScale(QwtPlot::xBottom, 0, maxSize, xStep);
 
         if (marker != nullptr)
             marker->detach();
 
-        replot();
+        scheduleReplot();
     }
 
     void MouseMonitorPlot::clearCurves()
     {
         curves.clear();
-        xData.clear();
+        nextIndex = 0;
 
-        replot();
+        scheduleReplot();
     }
 
 }
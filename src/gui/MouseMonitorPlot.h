@@ -1,12 +1,22 @@
 /**
  * This plot class is from the Smart-Minotaur project.
  *
+ * The curves read their points directly from a ring buffer
+ * (RingSeriesData), so appending a point copies nothing. Redraws are
+ * coalesced by a timer: updatePlot() only schedules a replot, which
+ * happens at most refreshRate times per second.
+ *
+ * LIMITED plots keep the last maxSize points and scroll, NO_LIMIT plots
+ * keep all points until clear(). setSeries() replaces all curves at
+ * once (e.g. a whole spectrum).
+ *
  * @author Jens Gansloser
  */
 
 #ifndef MOUSE_MONITOR_PLOT_H
 #define MOUSE_MONITOR_PLOT_H
 
+#include <initializer_list>
 #include <memory>
 
 #include <qwt_plot_curve.h>
@@ -14,24 +24,59 @@
 #include <qwt_plot.h>
 #include <qwt_legend.h>
 #include <qwt_plot_marker.h>
+#include <qwt_series_data.h>
 #include <QVector>
+#include <QTimer>
+
+#define DEFAULT_REFRESH_RATE 30 // Hz
 
 namespace minotaur
 {
 
+    /**
+     * Points of one curve. With a capacity, the oldest point is
+     * overwritten when the buffer is full.
+     */
+    class RingSeriesData : public QwtSeriesData<QPointF>
+    {
+        private:
+            QVector<QPointF> points;
+            int capacity = 0; // 0: Unlimited
+            int start = 0; // Oldest point
+
+        public:
+            void setCapacity(int capacity);
+            void append(const QPointF &point);
+            void clear();
+
+            /**
+             * Replaces all points (ignores the capacity).
+             */
+            void assign(const double *x, const double *y, int size);
+            void assign(double x0, double dx, const double *y, int size);
+
+            virtual size_t size() const;
+            virtual QPointF sample(size_t i) const;
+            virtual QRectF boundingRect() const;
+    };
+
     struct CurveContainer {
         QwtPlotCurve curve;
-        QVector<double> yData;
+        // Owned by the curve.
+        RingSeriesData *data;
 
         CurveContainer(QString curveTitle, QColor color) : curve(curveTitle) {
             curve.setPen(QPen(color, 1.0));
+
+            data = new RingSeriesData();
+            curve.setData(data);
         }
 
         ~CurveContainer() {
         }
 
-        void update(double data) {
-            yData.append(data);
+        void update(double x, double y) {
+            data->append(QPointF(x, y));
         }
     };
 
@@ -43,7 +88,8 @@ namespace minotaur
 
         private:
             QVector<std::shared_ptr<CurveContainer>> curves;
-            QVector<double> xData;
+            // x value of the next updatePlot(data) point
+            double nextIndex = 0;
 
             int xStep;
             int maxSize;
@@ -56,9 +102,24 @@ namespace minotaur
             QwtLegend *legend;
             QwtPlotMarker *marker = nullptr;
 
+            QTimer replotTimer;
+
+            void scheduleReplot();
+
+        private slots:
+            void refresh();
+
+        signals:
+            // refresh() painted the scheduled changes.
+            void replotted();
+
         public:
             MouseMonitorPlot(QWidget *parent = 0) : QwtPlot(parent) {}
-            virtual ~MouseMonitorPlot() {}
+            virtual ~MouseMonitorPlot() {
+                // Attached items are deleted by QwtPlot.
+                if (marker != nullptr && marker->plot() != this)
+                    delete marker;
+            }
 
             void init(QColor color,
                       std::string title,
@@ -67,8 +128,21 @@ namespace minotaur
                       std::string curveTitle,
                       PLOT_TYPE type);
 
-            void updatePlot(QVector<double> data);
-            void updatePlot(double xIndex, QVector<double> data);
+            /**
+             * One value per curve. The plot is redrawn by the timer.
+             */
+            void updatePlot(const QVector<double> &data);
+            void updatePlot(double xIndex, const QVector<double> &data);
+
+            /**
+             * Replaces the points of all curves, one y buffer (of size
+             * values) per curve. The plot is redrawn once by the timer.
+             */
+            void setSeries(const double *x,
+                           std::initializer_list<const double *> ys, int size);
+            // x values x0 + i * dx
+            void setSeries(double x0, double dx,
+                           std::initializer_list<const double *> ys, int size);
 
             void clearCurves();
             void clear();
@@ -78,9 +152,18 @@ namespace minotaur
 
             void addCurve(QString curveTitle, QColor color);
 
-            void addMarker(double xPos, double yPos);
+            /**
+             * Moves the (single) peak marker.
+             */
+            void setMarker(double xPos, double yPos);
+            void clearMarker();
 
             void setLimit(int limit);
+
+            /**
+             * Maximum number of redraws per second.
+             */
+            void setRefreshRate(int refreshRate);
     };
 
 }
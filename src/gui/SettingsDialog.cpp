@@ -38,12 +38,12 @@ namespace hrm
 
     void SettingsDialog::setSensorInfo(SensorSettings settings)
     {
-        sensorEdit->setText(settings.sensor);
-        idEdit->setText(settings.id);
-        maxValEdit->setText(settings.max);
-        minValEdit->setText(settings.min);
-        sampleIntervalEdit->setText(settings.sampleInterval);
-        resolutionEdit->setText(settings.resolution);
+        sensorEdit->setText(QString::fromStdString(settings.sensor));
+        idEdit->setText(QString::fromStdString(settings.id));
+        maxValEdit->setText(QString::fromStdString(settings.max));
+        minValEdit->setText(QString::fromStdString(settings.min));
+        sampleIntervalEdit->setText(QString::fromStdString(settings.sampleInterval));
+        resolutionEdit->setText(QString::fromStdString(settings.resolution));
     }
 
     void SettingsDialog::clearFrequencyDataEdit()
@@ -61,20 +61,42 @@ namespace hrm
         frequencyDataEdit->append(QString::number(magnitude));
     }
 
-    void SettingsDialog::setTimeDataEdit(double broadband)
+    void SettingsDialog::setFrequencyDataEdit(const double *magnitude, int size)
     {
-        timeDataEdit->append(QString::number(broadband));
+        QString text;
+        for (int i = 0; i < size; ++i) {
+            text += QString::number(magnitude[i]);
+            text += '\n';
+        }
+
+        frequencyDataEdit->setPlainText(text);
+    }
+
+    void SettingsDialog::setTimeDataEdit(const double *broadband, int size)
+    {
+        if (size <= 0)
+            return;
+
+        QString text;
+        for (int i = 0; i < size; ++i) {
+            if (i > 0)
+                text += '\n';
+            text += QString::number(broadband[i]);
+        }
+
+        timeDataEdit->append(text);
     }
 
-    void SettingsDialog::setPeakInfo(int indexMax, double fraction,
+    void SettingsDialog::setPeakInfo(double indexMax, double fraction,
                                      double frequency, double max,
-                                     double bpm)
+                                     double bpm, double confidence)
     {
         peakIndexEdit->setText(QString::number(indexMax));
         peakFractionEdit->setText(QString::number(fraction));
         peakFrequencyEdit->setText(QString::number(frequency));
         peakAmplitudeEdit->setText(QString::number(max));
         peakBpmEdit->setText(QString::number(bpm));
+        peakConfidenceEdit->setText(QString::number(confidence));
     }
 
 }
@@ -21,12 +21,15 @@ namespace hrm
 
             void setSensorInfo(SensorSettings settings);
             void setFFTInfo(FFT_properties properties);
-            void setPeakInfo(int indexMax, double fraction,
+            void setPeakInfo(double indexMax, double fraction,
                              double frequency, double max,
-                             double bpm);
+                             double bpm, double confidence);
 
-            void setTimeDataEdit(double broadband);
+            // Appends one line per value.
+            void setTimeDataEdit(const double *broadband, int size);
             void setFrequencyDataEdit(double magnitude);
+            // Replaces the content (one line per value).
+            void setFrequencyDataEdit(const double *magnitude, int size);
             void clearTimeDataEdit();
             void clearFrequencyDataEdit();
     };
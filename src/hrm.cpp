@@ -1,11 +1,49 @@
 #include "MainWindow.h"
+#include "FFTPlanCache.h"
+
+#include <QDir>
+
+#ifdef Qt5
+#include <QStandardPaths>
+#else
+#include <QDesktopServices>
+#endif
+
+#define WISDOM_FILE_NAME "fftw.wisdom"
+
+/**
+ * @return Path of the FFTW wisdom file in the users' config directory.
+ */
+static QString wisdomFileName() {
+#ifdef Qt5
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation);
+#else
+    QString dir = QDesktopServices::storageLocation(QDesktopServices::DataLocation);
+#endif
+    dir += "/hrm";
+    QDir().mkpath(dir);
+
+    return dir + "/" + WISDOM_FILE_NAME;
+}
 
 int main(int argc, char **argv) {
     QApplication app(argc, argv);
-    hrm::MainWindow hrm;
 
-    hrm.show();
+    std::string wisdom = QDir::toNativeSeparators(wisdomFileName()).toStdString();
+    hrm::FFTPlanCache::instance().loadWisdom(wisdom);
+
+    int status;
+    {
+        hrm::MainWindow hrm;
+
+        hrm.show();
+
+        app.connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
+        status = app.exec();
+    }
 
-    app.connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
-    return app.exec();
+    // Queued measurements are dropped, a running one is finished first.
+    hrm::FFTPlanCache::instance().stop();
+    hrm::FFTPlanCache::instance().saveWisdom(wisdom);
+    return status;
 }